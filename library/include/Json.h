@@ -5,8 +5,16 @@
 #include <JsonDataTree/JsonValue.h>
 #include <JsonDataTree/JsonArray.h>
 #include <JsonDataTree/JsonObject.h>
+#include <JsonDataTree/JsonHandler.h>
 #include <JsonDataTree/JsonReader.h>
+#include <JsonDataTree/JsonReaderSession.h>
+#include <JsonDataTree/JsonDocument.h>
+#include <JsonDataTree/JsonKeyTable.h>
+#include <JsonDataTree/JsonTokenReader.h>
+#include <JsonDataTree/JsonStreamReader.h>
+#include <JsonDataTree/JsonLinesReader.h>
 #include <JsonDataTree/JsonWriter.h>
+#include <JsonDataTree/JsonStreamWriter.h>
 #include <JsonDataTree/JsonPath.h>
 
 #endif
\ No newline at end of file
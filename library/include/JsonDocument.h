@@ -0,0 +1,121 @@
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonPath.h>
+
+// for implicit sharing
+#include <QSharedDataPointer>
+
+namespace JSON
+{
+    // internal data
+    class JsonDocumentPrivate;
+
+    /**
+     * \brief A parsed document that keeps all of its
+     *          values in one block of memory.
+     *
+     * Reading a document into a `JsonValue` makes every string,
+     * array, and object in it on the heap on its own, and frees
+     * them one at a time when the value goes away. A document
+     * read by `JsonReader::parseDocument()` or
+     * `JsonReader::readDocument()` instead packs all of its
+     * values one after another into a few large blocks, which
+     * are freed all at once. This is quicker to build and to get
+     * rid of, which is what matters for a document that is only
+     * looked at briefly.
+     *
+     * The values are read through ordinary `JsonValue`s. An array
+     * or object is only made into one when something first looks
+     * inside of it, and only one level at a time; `follow()` goes
+     * straight to a value without making any of the ones around
+     * it. The blocks are kept for as long as the document, or any
+     * value from it that has not been looked inside of yet, is
+     * around.
+     *
+     * A document cannot be changed; changing a value from it
+     * only changes that value. Copies share the same blocks.
+     */
+    class JSON_LIBRARY JsonDocument
+    {
+        public:
+            /**
+             * \brief Construct an empty document,
+             *          whose root is `null`.
+             */
+            JsonDocument();
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonDocument();
+
+            /**
+             * \brief Make a document that shares
+             *          the values of another.
+             *
+             * \param[in] other The document to share.
+             */
+            JsonDocument(const JsonDocument& other);
+
+            /**
+             * \brief Share the values of another document.
+             *
+             * \param[in] other The document to share.
+             *
+             * \returns This document.
+             */
+            auto operator= (const JsonDocument& other) -> JsonDocument&;
+
+            /**
+             * \brief Get the value the document is made of.
+             *
+             * Every call returns a copy of the same value, so
+             * its arrays and objects are only made once.
+             *
+             * \returns The root value.
+             */
+            auto root() const -> JsonValue;
+
+            /**
+             * \brief Get the value at the end of a path.
+             *
+             * This works like `JsonValue::follow()` on the root,
+             * but only the value found is made, not the arrays
+             * and objects on the way to it.
+             *
+             * \param[in] path The path to follow.
+             * \param[out] ok A flag set to `true` if `path` is valid
+             *                    for this document, `false` otherwise.
+             *
+             * \returns The value at the end of the path, or `Null`
+             *          if the path is not valid.
+             */
+            auto follow(JsonPath path, bool* ok = nullptr) const -> JsonValue;
+
+            /**
+             * \brief Get how much memory the values take up.
+             *
+             * \returns The size of the blocks the values are
+             *          kept in, in bytes.
+             */
+            auto memoryUsed() const -> qint64;
+
+        private:
+            friend class JsonReader;
+
+            /**
+             * \brief Make a document out of its data.
+             */
+            JsonDocument(JsonDocumentPrivate* d);
+
+            /** \brief The *d-pointer* for this object. */
+            QSharedDataPointer<JsonDocumentPrivate> d;
+    };
+}
+
+#endif // JSON_DOCUMENT_H
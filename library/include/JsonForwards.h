@@ -16,14 +16,38 @@ class QString;
  **/
 namespace JSON
 {
+	// JsonHandler.h
+	class JsonHandler;
+
 	// JsonReader.h
 	class JsonReader;
 	class JsonReaderError;
 	class JsonReaderErrors;
 
+	// JsonReaderSession.h
+	class JsonReaderSession;
+
+	// JsonDocument.h
+	class JsonDocument;
+
+	// JsonKeyTable.h
+	class JsonKeyTable;
+
+	// JsonTokenReader.h
+	class JsonTokenReader;
+
+	// JsonStreamReader.h
+	class JsonStreamReader;
+
+	// JsonLinesReader.h
+	class JsonLinesReader;
+
 	// JsonWriter.h
 	class JsonWriter;
 
+	// JsonStreamWriter.h
+	class JsonStreamWriter;
+
 	// JsonValue.h
 	class JsonValue;
 
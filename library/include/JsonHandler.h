@@ -0,0 +1,143 @@
+#ifndef JSON_HANDLER_H
+#define JSON_HANDLER_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+
+// for the data
+#include <QString>
+
+namespace JSON
+{
+	/**
+	 * \brief An interface for taking in a document one
+	 *			part at a time, as `JsonReader` reads it.
+	 *
+	 * Instead of building a `JsonValue` tree, the reader calls
+	 * these functions in document order. Each of them returns
+	 * `true` to keep going, or `false` to stop the reader, which
+	 * then reports a `JsonReaderError::StoppedByHandler` error.
+	 * By default, every part is ignored; override the ones
+	 * that matter.
+	 *
+	 * If the document has a mistake in it, the handler gets
+	 * everything up to the mistake and the reader reports the
+	 * error as usual.
+	 */
+	class JSON_LIBRARY JsonHandler
+	{
+		public:
+			/**
+			 * \brief Destroy this object.
+			 */
+			virtual ~JsonHandler();
+
+			/**
+			 * \brief Called at the `{` of an object.
+			 *
+			 * The object's contents follow as pairs
+			 * of `key()` and a value.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto startObject() -> bool;
+
+			/**
+			 * \brief Called with the key of the next value
+			 *			in an object.
+			 *
+			 * \param[in] key The key.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto key(const QString& key) -> bool;
+
+			/**
+			 * \brief Called at the `}` of an object.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto endObject() -> bool;
+
+			/**
+			 * \brief Called at the `[` of an array.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto startArray() -> bool;
+
+			/**
+			 * \brief Called at the `]` of an array.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto endArray() -> bool;
+
+			/**
+			 * \brief Called with a string value.
+			 *
+			 * \param[in] value The string, with the
+			 *				escapes decoded.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto string(const QString& value) -> bool;
+
+			/**
+			 * \brief Called with a number.
+			 *
+			 * Integers go to `integer()` or `unsignedInteger()`
+			 * first, which pass them on to here unless they are
+			 * overridden.
+			 *
+			 * \param[in] value The number.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto number(double value) -> bool;
+
+			/**
+			 * \brief Called with a number written without a
+			 *			fraction or exponent that fits in a `qint64`.
+			 *
+			 * By default, this passes the number on to `number()`.
+			 *
+			 * \param[in] value The number.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto integer(qint64 value) -> bool;
+
+			/**
+			 * \brief Called with a number written without a
+			 *			fraction or exponent that is too big for
+			 *			a `qint64`, but fits in a `quint64`.
+			 *
+			 * By default, this passes the number on to `number()`.
+			 *
+			 * \param[in] value The number.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto unsignedInteger(quint64 value) -> bool;
+
+			/**
+			 * \brief Called with `true` or `false`.
+			 *
+			 * \param[in] value The value.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto boolean(bool value) -> bool;
+
+			/**
+			 * \brief Called with `null`.
+			 *
+			 * \returns `true` to keep reading.
+			 */
+			virtual auto null() -> bool;
+	};
+}
+
+#endif // JSON_HANDLER_H
@@ -0,0 +1,76 @@
+#ifndef JSON_KEY_TABLE_H
+#define JSON_KEY_TABLE_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+
+// for the data
+#include <QString>
+#include <QScopedPointer>
+
+namespace JSON
+{
+    // internal data
+    class JsonKeyTablePrivate;
+
+    /**
+     * \brief A set of object keys that readers share, so that
+     *          each key is only held in memory once.
+     *
+     * Every reader already keeps the keys of the document it is
+     * reading in a table of its own, so that all of the objects
+     * with a key like `"id"` share one `QString` for it. Giving
+     * several readers the same `JsonKeyTable` does the same across
+     * all of their documents, which helps when many documents
+     * with the same keys are kept around at once.
+     *
+     * A table can be used by several threads at the same time.
+     * It only grows; `clear()` empties it.
+     */
+    class JSON_LIBRARY JsonKeyTable
+    {
+        public:
+            /**
+             * \brief Construct an empty table.
+             */
+            JsonKeyTable();
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonKeyTable();
+
+            /**
+             * \brief Get the copy of `key` held in this table,
+             *          adding `key` if it is not there yet.
+             *
+             * \param[in] key The key to look up.
+             *
+             * \returns A string equal to `key`, which shares
+             *          its data with the table.
+             */
+            auto intern(const QString& key) -> QString;
+
+            /**
+             * \brief Get the number of keys in this table.
+             *
+             * \returns The number of keys.
+             */
+            auto size() const -> int;
+
+            /**
+             * \brief Remove every key from this table.
+             *
+             * Values that were already read keep their keys.
+             */
+            auto clear() -> void;
+
+        private:
+            Q_DISABLE_COPY(JsonKeyTable)
+
+            QScopedPointer<JsonKeyTablePrivate> d;
+    };
+}
+
+#endif // JSON_KEY_TABLE_H
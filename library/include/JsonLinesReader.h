@@ -0,0 +1,202 @@
+#ifndef JSON_LINES_READER_H
+#define JSON_LINES_READER_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonArray.h>
+#include <JsonDataTree/JsonReader.h>
+
+// for implicit sharing
+#include <QSharedDataPointer>
+
+// for reading the data
+#include <QIODevice>
+#include <QList>
+
+// for the callback
+#include <functional>
+
+class QThreadPool;
+
+namespace JSON
+{
+    // internal data
+    class JsonLinesReaderPrivate;
+
+    /**
+     * \brief Reads newline-delimited JSON (JSON Lines), one
+     *          value per line, on several threads at once.
+     *
+     * The input is cut into chunks of whole lines, and the chunks
+     * are parsed on a `QThreadPool`, so a large log is read about
+     * as many times faster as there are threads in the pool. Only
+     * a few chunks are held in memory at a time.
+     *
+     * Each line is parsed the same way `JsonReader` parses a
+     * document, and gets its own `JsonReaderErrors`, with offsets
+     * from the start of the line; a mistake on one line does not
+     * stop the others from being read. Lines that are empty or
+     * only white space are skipped. The text must be UTF-8.
+     */
+    class JSON_LIBRARY JsonLinesReader
+    {
+        public:
+            /**
+             * \brief Receives the value read from one line.
+             *
+             * The arguments are the line number (counting from
+             * `0`), the value, and the errors for that line.
+             */
+            using Callback = std::function<void (qint64, JsonValue, JsonReaderErrors)>;
+
+            /**
+             * \brief Construct a reader that uses the
+             *          global thread pool.
+             */
+            JsonLinesReader();
+
+            /**
+             * \brief Make a copy of `other`.
+             *
+             * \param[in] other The reader to copy.
+             */
+            JsonLinesReader(const JsonLinesReader& other);
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonLinesReader();
+
+            /**
+             * \brief Make this reader a copy of `other`.
+             *
+             * \param[in] other The reader to copy.
+             */
+            auto operator= (const JsonLinesReader& other) -> JsonLinesReader&;
+
+            /**
+             * \brief Get the engine used for each line.
+             *
+             * \returns The engine.
+             */
+            auto getEngine() const -> JsonReader::Engine;
+
+            /**
+             * \brief Set the engine used for each line.
+             *
+             * \param[in] engine The engine to use.
+             */
+            auto setEngine(JsonReader::Engine engine) -> void;
+
+            /**
+             * \brief Get the dialect each line is read in.
+             *
+             * \returns The dialect.
+             */
+            auto getDialect() const -> JsonReader::Dialect;
+
+            /**
+             * \brief Set the dialect each line is read in.
+             *
+             * \param[in] dialect The dialect to use; the default
+             *              is `JsonReader::CommentDialect`.
+             */
+            auto setDialect(JsonReader::Dialect dialect) -> void;
+
+            /**
+             * \brief Get the pool the lines are parsed on.
+             *
+             * \returns The thread pool.
+             */
+            auto getThreadPool() const -> QThreadPool*;
+
+            /**
+             * \brief Set the pool the lines are parsed on.
+             *
+             * \param[in] pool The thread pool to use, or `nullptr`
+             *              for `QThreadPool::globalInstance()`.
+             */
+            auto setThreadPool(QThreadPool* pool) -> void;
+
+            /**
+             * \brief Get the size of the chunks the input is cut into.
+             *
+             * \returns The size of a chunk in bytes.
+             */
+            auto getChunkSize() const -> int;
+
+            /**
+             * \brief Set the size of the chunks the input is cut into.
+             *
+             * A chunk is made longer if it would otherwise end in
+             * the middle of a line. The default is 1 MiB.
+             *
+             * \param[in] bytes The size of a chunk in bytes.
+             */
+            auto setChunkSize(int bytes) -> void;
+
+            /**
+             * \brief Get the table object keys are shared through.
+             *
+             * \returns The key table, or `nullptr`.
+             */
+            auto getKeyTable() const -> JsonKeyTable*;
+
+            /**
+             * \brief Set the table object keys are shared through.
+             *
+             * The lines in a chunk always share their keys; see
+             * `JsonReader::setKeyTable()` for what a table adds.
+             *
+             * \param[in] table The key table to use, or `nullptr`
+             *              (the default).
+             */
+            auto setKeyTable(JsonKeyTable* table) -> void;
+
+            /**
+             * \brief Read the rest of the IO device.
+             *
+             * \param[in] io The IO device to read from.
+             * \param[out] errors If not `nullptr`, the errors for each
+             *              value are appended here, in the same order
+             *              as the values.
+             *
+             * \returns The values, in the order of their lines.
+             */
+            auto read(QIODevice* io, QList<JsonReaderErrors>* errors = nullptr) const -> JsonArray;
+
+            /**
+             * \brief Read the rest of the IO device, handing each
+             *          value to `callback` as soon as it is ready.
+             *
+             * If `ordered` is `true`, `callback` is called on this
+             * thread, in the order of the lines. Otherwise, it is
+             * called on the pool's threads, several at a time and in
+             * no particular order, which saves waiting for the lines
+             * before; it then has to be thread-safe.
+             *
+             * Either way, this returns once every line has been
+             * handed over.
+             *
+             * A device holding gzip or zlib compressed text is
+             * inflated on a thread of its own as it is read; a
+             * stream that is cut short or corrupt makes this
+             * return `false`, after the lines before the break.
+             *
+             * \param[in] io The IO device to read from.
+             * \param[in] callback What to hand the values to.
+             * \param[in] ordered Whether to keep the values in order.
+             *
+             * \returns `true` if every line was read without
+             *          errors, `false` otherwise.
+             */
+            auto read(QIODevice* io, Callback callback, bool ordered = true) const -> bool;
+
+        private:
+            QSharedDataPointer<JsonLinesReaderPrivate> d;
+    };
+}
+
+#endif // JSON_LINES_READER_H
@@ -5,6 +5,10 @@
 #include <JsonDataTree/JsonForwards.h>
 #include <JsonDataTree/LibraryMacros.h>
 #include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonArray.h>
+#include <JsonDataTree/JsonHandler.h>
+#include <JsonDataTree/JsonPath.h>
+#include <JsonDataTree/JsonDocument.h>
 
 // superclass
 #include <QObject>
@@ -17,9 +21,18 @@
 #include <QIODevice>
 #include <QString>
 
+// for reading in the background
+#include <QFuture>
+
+// for batches
+#include <QByteArray>
+#include <QList>
+
 // for errors
 #include <QString>
 
+class QThreadPool;
+
 namespace JSON
 {
     // internal data
@@ -34,7 +47,78 @@ namespace JSON
     {
         Q_OBJECT
 
+        Q_ENUMS(Engine)
+        Q_ENUMS(Dialect)
+
+        Q_PROPERTY(Engine engine
+                   READ getEngine
+                   WRITE setEngine)
+        Q_PROPERTY(Dialect dialect
+                   READ getDialect
+                   WRITE setDialect)
+        Q_PROPERTY(bool lazy
+                   READ isLazy
+                   WRITE setLazy)
+        Q_PROPERTY(bool zeroCopy
+                   READ isZeroCopy
+                   WRITE setZeroCopy)
+        Q_PROPERTY(int maxDepth
+                   READ getMaxDepth
+                   WRITE setMaxDepth)
+
         public:
+            /**
+             * \brief The parsing engines a reader can use.
+             *
+             * Both engines produce the same values and the
+             * same errors; they only differ in speed.
+             */
+            enum Engine {
+                /**
+                 * Read the text one character at a time.
+                 * Best for small documents.
+                 */
+                RecursiveDescentEngine = 0,
+                /**
+                 * Find all of the tokens with SIMD instructions
+                 * first (AVX2 or SSE4.2, whichever the CPU has),
+                 * then build the values from that index. Best
+                 * for large documents. Documents with comments
+                 * or errors are handed to the other engine.
+                 */
+                StructuralIndexEngine
+            };
+
+            /**
+             * \brief What a reader accepts besides standard JSON.
+             *
+             * The reader is built separately for each dialect,
+             * so the strict one does not even check for comments.
+             */
+            enum Dialect {
+                /**
+                 * Only standard JSON.
+                 */
+                StrictDialect = 0,
+                /**
+                 * Line (`//`) and block comments wherever
+                 * white space can go.
+                 */
+                CommentDialect,
+                /**
+                 * Comments, and a comma after the last value
+                 * of an array or object.
+                 */
+                RelaxedDialect
+            };
+
+            /**
+             * \brief How deeply arrays and objects can be
+             *          nested unless `setMaxDepth()` says
+             *          otherwise.
+             */
+            static const int DefaultMaxDepth = 512;
+
             /**
              * \brief Construct a reader.
              */
@@ -52,6 +136,193 @@ namespace JSON
              */
             JsonReader(const JsonReader& other);
 
+            /**
+             * \brief Get the engine used to parse documents.
+             *
+             * \returns The engine used to parse documents.
+             */
+            auto getEngine() const -> Engine;
+
+            /**
+             * \brief Set the engine used to parse documents.
+             *
+             * \param[in] engine The engine to use.
+             */
+            auto setEngine(Engine engine) -> void;
+
+            /**
+             * \brief Get what the reader accepts besides
+             *          standard JSON.
+             *
+             * \returns The dialect documents are read in.
+             */
+            auto getDialect() const -> Dialect;
+
+            /**
+             * \brief Set what the reader accepts besides
+             *          standard JSON.
+             *
+             * Anything the dialect does not allow is reported as
+             * an error, the same way as any other mistake; with
+             * `StrictDialect`, a comment is an unexpected `/`.
+             * Lazy and selective reads use the dialect as well.
+             *
+             * \param[in] dialect The dialect to read documents
+             *              in. The default is `CommentDialect`,
+             *              which is how documents have always
+             *              been read.
+             */
+            auto setDialect(Dialect dialect) -> void;
+
+            /**
+             * \brief Get how deeply arrays and objects
+             *          can be nested.
+             *
+             * \returns The most arrays and objects that can be
+             *          nested inside of each other, or `0` if
+             *          there is no limit.
+             */
+            auto getMaxDepth() const -> int;
+
+            /**
+             * \brief Set how deeply arrays and objects
+             *          can be nested.
+             *
+             * An array or object nested any deeper is reported
+             * as a `JsonReaderError::NestingTooDeep` error at its
+             * `[` or `{`. The reader itself keeps track of the
+             * nesting on the heap, so it can read any depth, but
+             * values nested thousands deep are still destroyed
+             * one level at a time on the stack, and machine-made
+             * or hostile documents are seldom nested on purpose.
+             * The parts of a document skipped by a selective
+             * read are not checked.
+             *
+             * \param[in] depth The most arrays and objects that can
+             *              be nested inside of each other, or `0`
+             *              for no limit. The default is
+             *              `DefaultMaxDepth`.
+             */
+            auto setMaxDepth(int depth) -> void;
+
+            /**
+             * \brief Get the pool large arrays are parsed on.
+             *
+             * \returns The thread pool, or `nullptr`
+             *          if everything is parsed on the
+             *          calling thread, and asynchronous
+             *          reads on the global pool.
+             */
+            auto getThreadPool() const -> QThreadPool*;
+
+            /**
+             * \brief Set the pool large arrays are parsed on.
+             *
+             * When the document is a large array (a megabyte or
+             * more), it is cut into pieces at guessed boundaries
+             * between elements, and the pieces are parsed at the
+             * same time on the pool. The guesses are checked as
+             * the pieces are joined, and a piece that started in
+             * the wrong place is parsed again, so the result is
+             * the same as it is without a pool. This only applies
+             * when building values, not when using a `JsonHandler`.
+             * Asynchronous reads and batches are run on the pool
+             * as well.
+             *
+             * \param[in] pool The thread pool to use, or `nullptr`
+             *              to parse on the calling thread (the
+             *              default).
+             */
+            auto setThreadPool(QThreadPool* pool) -> void;
+
+            /**
+             * \brief Get the table object keys are shared through.
+             *
+             * \returns The key table, or `nullptr` if each
+             *          document has keys of its own.
+             */
+            auto getKeyTable() const -> JsonKeyTable*;
+
+            /**
+             * \brief Set the table object keys are shared through.
+             *
+             * Within a document, objects with the same key always
+             * share one string for it. With a table, documents
+             * share them too. The table is not owned by the reader,
+             * and has to outlive it.
+             *
+             * \param[in] table The key table to use, or `nullptr`
+             *              to keep the keys of each document to
+             *              themselves (the default).
+             */
+            auto setKeyTable(JsonKeyTable* table) -> void;
+
+            /**
+             * \brief Check if arrays and objects are read
+             *          when they are first used.
+             *
+             * \returns `true` if they are read lazily,
+             *          `false` if they are read up front.
+             */
+            auto isLazy() const -> bool;
+
+            /**
+             * \brief Choose whether arrays and objects are read
+             *          when they are first used.
+             *
+             * A lazy reader still checks the whole document, so
+             * mistakes are reported up front, and it notes where
+             * every array and object ends. It then keeps the text
+             * and returns values whose arrays and objects are only
+             * read, one level at a time, when `toArray()`,
+             * `toObject()` or `follow()` first looks inside them.
+             * When only a few parts of a large document are used,
+             * this saves building all of the others.
+             *
+             * A document with a mistake in it is read up front.
+             * This only applies when building values, not when
+             * using a `JsonHandler`.
+             *
+             * \param[in] lazy `true` to read lazily, `false` to
+             *              read everything up front (the default).
+             */
+            auto setLazy(bool lazy) -> void;
+
+            /**
+             * \brief Check if strings are left in the
+             *          text they were read from.
+             *
+             * \returns `true` if they are left in the text,
+             *          `false` if they are copied out of it.
+             */
+            auto isZeroCopy() const -> bool;
+
+            /**
+             * \brief Choose whether strings are left in the
+             *          text they were read from.
+             *
+             * A zero-copy reader keeps the whole text, and string
+             * values without escapes in them only note where they
+             * are in it. They are decoded each time `toString()`
+             * is called on them, instead of while reading, which
+             * makes documents full of strings quicker to read and
+             * smaller to keep. The text is kept for as long as any
+             * of these strings are, even if they are the only part
+             * of the document still in use, so copy a string into
+             * a value of its own to keep just that string. Devices
+             * are read into memory instead of being mapped, as the
+             * text has to outlive them.
+             *
+             * This works with lazy and selective reads, but only
+             * applies when building values, not when using a
+             * `JsonHandler` or reading a `JsonDocument`.
+             *
+             * \param[in] zeroCopy `true` to leave strings in the
+             *              text, `false` to copy them out of it
+             *              (the default).
+             */
+            auto setZeroCopy(bool zeroCopy) -> void;
+
             /**
              * \brief Parse the value from the
              *          given string.
@@ -68,6 +339,20 @@ namespace JSON
              * \brief Read the data from the given
              *          IO device.
              *
+             * The data is expected to be UTF-8, unless it
+             * starts with a UTF-16 or UTF-32 byte order mark.
+             * Files are mapped into memory and parsed in place;
+             * other devices are read into a buffer first. Error
+             * offsets are in bytes from the current position.
+             *
+             * Data compressed with gzip or zlib is recognized by
+             * its header, and inflated on a thread of its own
+             * while the device is read, straight into the buffer
+             * it is parsed from. Error offsets are then in the
+             * inflated text, and a stream that is cut short or
+             * corrupt adds a `JsonReaderError::StreamFailure`
+             * where the inflated text stops.
+             *
              * \param[in] io The IO device to read from.
              * \param[out] errors A list of all errors
              *                      that occured.
@@ -86,7 +371,287 @@ namespace JSON
             auto read(QTextStream& stream,
                       JsonReaderErrors* errors = nullptr) const -> JsonValue;
 
+            /**
+             * \brief Read a file on the thread pool.
+             *
+             * The file is read the way `read(QIODevice*,
+             * JsonReaderErrors*)` reads it, with this reader's
+             * settings as they are now, on the reader's thread pool
+             * (or `QThreadPool::globalInstance()` if it has none).
+             * This returns right away, so the calling thread's event
+             * loop keeps running while the file is read.
+             *
+             * The future's progress is the number of bytes of
+             * text parsed so far, out of all of them, and is updated
+             * every so often as the values are built. Canceling the
+             * future stops the parser at the next update; the result
+             * is then what was read up to there, and the errors end
+             * with a `JsonReaderError::StoppedByHandler`. A file
+             * that cannot be opened gives `null` and a
+             * `JsonReaderError::StreamFailure`. An asynchronous read
+             * is never split up over the pool, so that it can keep
+             * track of how far it got.
+             *
+             * \param[in] path The path of the file to read.
+             * \param[out] errors A list of all errors that occured;
+             *                      it is filled in on the pool, so
+             *                      it has to be left alone until the
+             *                      future has finished.
+             *
+             * \returns The value the file holds, once it has
+             *          been read.
+             */
+            auto readAsync(QString path,
+                           JsonReaderErrors* errors = nullptr) const -> QFuture<JsonValue>;
+
+            /**
+             * \brief Parse UTF-8 text on the thread pool.
+             *
+             * This works like `readAsync()`, with the text being read
+             * as if from a device; it may be compressed, and starting
+             * with a UTF-16 or UTF-32 byte order mark makes it be
+             * read as such.
+             *
+             * \param[in] data The text to parse.
+             * \param[out] errors A list of all errors that occured;
+             *                      it has to be left alone until the
+             *                      future has finished.
+             *
+             * \returns The value the text holds, once it has
+             *          been parsed.
+             */
+            auto parseAsync(QByteArray data,
+                            JsonReaderErrors* errors = nullptr) const -> QFuture<JsonValue>;
+
+            /**
+             * \brief Parse many small documents at once, spread
+             *          over the thread pool.
+             *
+             * The documents are split into runs of about the same
+             * amount of text, a few for every thread in the pool
+             * (or the global pool, without one), and one run is
+             * parsed on the calling thread. The documents in a run
+             * are parsed the way a `JsonReaderSession` parses them,
+             * sharing their keys and buffers, so there is little
+             * to pay for each document besides its values. A batch
+             * with little text in it is parsed on the calling thread
+             * alone. The text is read as it is by `parseAsync()`,
+             * except that each document is parsed on one thread,
+             * however large it is, since the pool is busy with the
+             * batch already.
+             *
+             * \param[in] data The documents to parse.
+             * \param[out] errors If not `nullptr`, the errors for each
+             *              document are appended here, in the same
+             *              order as the documents.
+             *
+             * \returns The values, in the order of their documents.
+             */
+            auto parseBatch(QList<QByteArray> data,
+                            QList<JsonReaderErrors>* errors = nullptr) const -> JsonArray;
+
+            /**
+             * \brief Parse the given string, only keeping the
+             *          values on the given paths.
+             *
+             * The paths are followed as the text is read, and
+             * everything off of them is skipped by matching up
+             * brackets and quotes, without building anything or
+             * checking what is inside. The result has the same
+             * shape as the document, with only the selected
+             * values in it, so `follow()` finds each of them
+             * where it would in the whole document; elements of
+             * an array that come before a selected one are `null`.
+             * A path that goes further than the document does only
+             * leaves behind the arrays and objects it got through.
+             * This is always read one character at a time, whatever
+             * the engine.
+             *
+             * \param[in] string The JSON string to
+             *          parse.
+             * \param[in] paths The paths of the values to keep.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto parse(QString string, QList<JsonPath> paths,
+                       JsonReaderErrors* errors = nullptr) const -> JsonValue;
+
+            /**
+             * \brief Read the data from the given IO device,
+             *          only keeping the values on the given paths.
+             *
+             * The device is read the same way as it is by
+             * `read(QIODevice*, JsonReaderErrors*)`, and the paths
+             * are used the same way as they are by
+             * `parse(QString, QList<JsonPath>, JsonReaderErrors*)`.
+             *
+             * \param[in] io The IO device to read from.
+             * \param[in] paths The paths of the values to keep.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto read(QIODevice* io, QList<JsonPath> paths,
+                      JsonReaderErrors* errors = nullptr) const -> JsonValue;
+
+            /**
+             * \brief Read the data from the given text stream,
+             *          only keeping the values on the given paths.
+             *
+             * \param[in] stream The text stream to read from.
+             * \param[in] paths The paths of the values to keep.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto read(QTextStream& stream, QList<JsonPath> paths,
+                      JsonReaderErrors* errors = nullptr) const -> JsonValue;
+
+            /**
+             * \brief Parse the given string into a document
+             *          that keeps its values in one block.
+             *
+             * See `JsonDocument` for how this differs from
+             * `parse(QString, JsonReaderErrors*)`. The engine and
+             * the depth limit apply as usual; the reader is never
+             * lazy and never uses the thread pool for documents.
+             *
+             * \param[in] string The JSON string to
+             *          parse.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto parseDocument(QString string,
+                               JsonReaderErrors* errors = nullptr) const -> JsonDocument;
+
+            /**
+             * \brief Read the data from the given IO device into
+             *          a document that keeps its values in one block.
+             *
+             * The device is read the same way as it is by
+             * `read(QIODevice*, JsonReaderErrors*)`.
+             *
+             * \param[in] io The IO device to read from.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto readDocument(QIODevice* io,
+                              JsonReaderErrors* errors = nullptr) const -> JsonDocument;
+
+            /**
+             * \brief Read the data from the given text stream into
+             *          a document that keeps its values in one block.
+             *
+             * \param[in] stream The text stream to read from.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             */
+            auto readDocument(QTextStream& stream,
+                              JsonReaderErrors* errors = nullptr) const -> JsonDocument;
+
+            /**
+             * \brief Parse the given string, handing each
+             *          part of it to `handler` instead of
+             *          building a value.
+             *
+             * \param[in] string The JSON string to
+             *          parse.
+             * \param[in] handler The handler to call.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             *
+             * \returns `true` if the whole value was read,
+             *          `false` if there was an error or
+             *          the handler stopped the reader.
+             */
+            auto parse(QString string, JsonHandler& handler,
+                       JsonReaderErrors* errors = nullptr) const -> bool;
+
+            /**
+             * \brief Read the data from the given IO device,
+             *          handing each part of it to `handler`
+             *          instead of building a value.
+             *
+             * The device is read the same way as it is by
+             * `read(QIODevice*, JsonReaderErrors*)`.
+             *
+             * \param[in] io The IO device to read from.
+             * \param[in] handler The handler to call.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             *
+             * \returns `true` if the whole value was read,
+             *          `false` if there was an error or
+             *          the handler stopped the reader.
+             */
+            auto read(QIODevice* io, JsonHandler& handler,
+                      JsonReaderErrors* errors = nullptr) const -> bool;
+
+            /**
+             * \brief Read the data from the given text stream,
+             *          handing each part of it to `handler`
+             *          instead of building a value.
+             *
+             * \param[in] stream The text stream to read from.
+             * \param[in] handler The handler to call.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             *
+             * \returns `true` if the whole value was read,
+             *          `false` if there was an error or
+             *          the handler stopped the reader.
+             */
+            auto read(QTextStream& stream, JsonHandler& handler,
+                      JsonReaderErrors* errors = nullptr) const -> bool;
+
+            /**
+             * \brief Check that the given UTF-8 text is well-formed,
+             *          without building anything out of it.
+             *
+             * The text is checked for invalid UTF-8 first, a block of
+             * 64 bytes at a time with SIMD instructions where the CPU
+             * has them; the first invalid sequence is reported as a
+             * `JsonReaderError::InvalidUtf8` error, and nothing else
+             * is checked. The parser itself only replaces invalid
+             * UTF-8, so this is stricter than `parse()` about it.
+             *
+             * Otherwise, the errors are the ones parsing the text
+             * would report, in the reader's dialect and with its
+             * depth limit. Strings and keys are checked but never
+             * decoded, and no values, strings, or lists are made, so
+             * this costs a fraction of what parsing does. A reader
+             * always checks one character at a time, whichever engine
+             * it is set up with, and never uses the thread pool.
+             *
+             * \param[in] data The text to check.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             *
+             * \returns `true` if the text is a well-formed
+             *          document, `false` otherwise.
+             */
+            auto validate(QByteArray data,
+                          JsonReaderErrors* errors = nullptr) const -> bool;
+
+            /**
+             * \brief Check that the given string is well-formed,
+             *          without building anything out of it.
+             *
+             * This is the same as `validate(QByteArray, JsonReaderErrors*)`,
+             * without the UTF-8 check.
+             *
+             * \param[in] string The JSON string to check.
+             * \param[out] errors A list of all errors
+             *                      that occured.
+             *
+             * \returns `true` if the string is a well-formed
+             *          document, `false` otherwise.
+             */
+            auto validate(QString string,
+                          JsonReaderErrors* errors = nullptr) const -> bool;
+
         private:
+            // so that a session can copy the settings
+            friend class JsonReaderSession;
+
             QSharedDataPointer<JsonReaderPrivate> d;
     };
 
@@ -116,7 +681,10 @@ namespace JSON
                 ArrayWithExtraComma,
                 ArrayWithNoClosingBracket,
                 CommentWithNoEnd,
-                StreamFailure
+                StreamFailure,
+                StoppedByHandler,
+                NestingTooDeep,
+                InvalidUtf8
             };
 
             /**
@@ -194,6 +762,10 @@ namespace JSON
             // so that `JsonReader` can add errors
             friend class JsonReader;
             friend class JsonReaderPrivate;
+            friend class JsonStreamReaderPrivate;
+            friend class JsonTokenReaderPrivate;
+            template <class Char, class Dialect>
+            friend class JsonCursor;
 
             /**
              * \brief Construct an empty grouping of errors.
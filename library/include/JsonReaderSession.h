@@ -0,0 +1,115 @@
+#ifndef JSON_READER_SESSION_H
+#define JSON_READER_SESSION_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonReader.h>
+
+// for implicit sharing
+#include <QSharedDataPointer>
+
+// for the text
+#include <QByteArray>
+#include <QString>
+
+namespace JSON
+{
+    // internal data
+    class JsonReaderSessionPrivate;
+
+    /**
+     * \brief Parses one small document after another, keeping
+     *          what it needs for parsing between them.
+     *
+     * Parsing a document with `JsonReader` sets up a key cache,
+     * a stack for the arrays and objects being built, a list
+     * for the errors, and, with the structural index engine, an
+     * index, and throws them all away again afterwards. For a
+     * large document, that hardly matters; for a stream of small
+     * messages, it can cost as much as the parsing itself.
+     *
+     * A session keeps all of these from one document to the
+     * next, so they only grow the first few times. Object keys
+     * that have been seen before are shared with the documents
+     * that had them, without being looked up in a
+     * `JsonKeyTable`. Documents without errors all share one
+     * empty `JsonReaderErrors`.
+     *
+     * A session is set up like the reader it is made from, and
+     * does not change when the reader does. It can only be used
+     * on one thread at a time; copies have buffers of their own
+     * once they are used, so each thread can have a copy.
+     * `JsonReader::parseBatch()` uses sessions on the thread pool.
+     */
+    class JSON_LIBRARY JsonReaderSession
+    {
+        public:
+            /**
+             * \brief Construct a session that reads the
+             *          way a new `JsonReader` does.
+             */
+            JsonReaderSession();
+
+            /**
+             * \brief Construct a session that reads the
+             *          way `reader` does.
+             *
+             * \param[in] reader The reader to copy the
+             *              settings of.
+             */
+            explicit JsonReaderSession(const JsonReader& reader);
+
+            /**
+             * \brief Make a copy of `other`.
+             *
+             * \param[in] other The session to copy.
+             */
+            JsonReaderSession(const JsonReaderSession& other);
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonReaderSession();
+
+            /**
+             * \brief Make this session a copy of `other`.
+             *
+             * \param[in] other The session to copy.
+             */
+            auto operator= (const JsonReaderSession& other) -> JsonReaderSession&;
+
+            /**
+             * \brief Parse the given text.
+             *
+             * UTF-8 is parsed where it is, without being decoded
+             * first. Text that is compressed, or that starts with
+             * a UTF-16 or UTF-32 byte order mark, is read as it is
+             * by `JsonReader::read(QIODevice*, JsonReaderErrors*)`.
+             *
+             * \param[in] data The text to parse.
+             * \param[out] errors If not `nullptr`, this is set to
+             *              the errors in this document.
+             *
+             * \returns The value the text holds.
+             */
+            auto parse(QByteArray data, JsonReaderErrors* errors = nullptr) -> JsonValue;
+
+            /**
+             * \brief Parse the given string.
+             *
+             * \param[in] string The JSON string to parse.
+             * \param[out] errors If not `nullptr`, this is set to
+             *              the errors in this document.
+             *
+             * \returns The value the string holds.
+             */
+            auto parse(QString string, JsonReaderErrors* errors = nullptr) -> JsonValue;
+
+        private:
+            QSharedDataPointer<JsonReaderSessionPrivate> d;
+    };
+}
+
+#endif // JSON_READER_SESSION_H
@@ -0,0 +1,158 @@
+#ifndef JSON_STREAM_READER_H
+#define JSON_STREAM_READER_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonReader.h>
+
+// for implicit sharing
+#include <QSharedDataPointer>
+
+// for the data
+#include <QByteArray>
+
+namespace JSON
+{
+    // internal data
+    class JsonStreamReaderPrivate;
+
+    /**
+     * \brief A push parser for UTF-8 text that arrives a piece
+     *          at a time, e.g. from a `QTcpSocket` or a
+     *          `QLocalSocket`.
+     *
+     * The text is a sequence of values separated by white space
+     * (e.g. newline-delimited JSON). Each piece is parsed as soon
+     * as it is fed in, so nothing has to be buffered until the
+     * end of a message; the parser keeps its place across pieces,
+     * even in the middle of a string, escape, number, or comment.
+     * Every value that has been read all the way through is put
+     * in a queue to be taken out with `takeValue()`:
+     *
+     *     reader.feed(socket->readAll());
+     *     while (reader.hasValue()) {
+     *         handle(reader.takeValue());
+     *     }
+     *
+     * Mistakes are reported as the same errors as `JsonReader`
+     * reports them, with offsets in bytes from the start of the
+     * stream. The reader stops at the first one.
+     */
+    class JSON_LIBRARY JsonStreamReader
+    {
+        public:
+            /**
+             * \brief Construct a reader at the start of a stream.
+             */
+            JsonStreamReader();
+
+            /**
+             * \brief Make a copy of `other`, which
+             *          continues from the same place.
+             *
+             * \param[in] other The reader to copy.
+             */
+            JsonStreamReader(const JsonStreamReader& other);
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonStreamReader();
+
+            /**
+             * \brief Make this reader a copy of `other`.
+             *
+             * \param[in] other The reader to copy.
+             */
+            auto operator= (const JsonStreamReader& other) -> JsonStreamReader&;
+
+            /**
+             * \brief Parse the next piece of the stream.
+             *
+             * \param[in] chunk The next bytes of the stream; they
+             *              can end anywhere, even in the middle
+             *              of a UTF-8 sequence.
+             *
+             * \returns `false` if there has been an error,
+             *          `true` otherwise.
+             */
+            auto feed(QByteArray chunk) -> bool;
+
+            /**
+             * \brief Tell the reader that the stream has ended.
+             *
+             * This finishes a number at the very end of the stream,
+             * and reports an error if the stream ends in the middle
+             * of a value. Afterwards, the reader starts over on a
+             * new stream; the values not taken yet are kept.
+             *
+             * \returns `false` if there has been an error,
+             *          `true` otherwise.
+             */
+            auto finish() -> bool;
+
+            /**
+             * \brief Check if a value is waiting to be taken.
+             *
+             * \returns `true` if `takeValue()` has a value
+             *          to return, `false` otherwise.
+             */
+            auto hasValue() const -> bool;
+
+            /**
+             * \brief Take the oldest value that has been read.
+             *
+             * \returns The value, or null if there is none.
+             */
+            auto takeValue() -> JsonValue;
+
+            /**
+             * \brief Get the errors that occured.
+             *
+             * \returns The errors so far.
+             */
+            auto errors() const -> JsonReaderErrors;
+
+            /**
+             * \brief Start over on a new stream, dropping
+             *          the errors and any values not taken.
+             */
+            auto reset() -> void;
+
+            /**
+             * \brief Get how deeply arrays and objects
+             *          can be nested.
+             *
+             * \returns The most arrays and objects that can be
+             *          nested inside of each other, or `0` if
+             *          there is no limit.
+             */
+            auto getMaxDepth() const -> int;
+
+            /**
+             * \brief Set how deeply arrays and objects
+             *          can be nested.
+             *
+             * An array or object nested any deeper is reported as
+             * a `JsonReaderError::NestingTooDeep` error at its `[`
+             * or `{`, as `JsonReader` does. Text from a socket can
+             * be nested as deep as its sender likes, and values
+             * nested thousands deep are destroyed one level at a
+             * time on the stack, so leave a limit in place for
+             * text that isn't trusted.
+             *
+             * \param[in] depth The most arrays and objects that can
+             *              be nested inside of each other, or `0`
+             *              for no limit. The default is
+             *              `JsonReader::DefaultMaxDepth`.
+             */
+            auto setMaxDepth(int depth) -> void;
+
+        private:
+            QSharedDataPointer<JsonStreamReaderPrivate> d;
+    };
+}
+
+#endif // JSON_STREAM_READER_H
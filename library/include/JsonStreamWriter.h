@@ -0,0 +1,349 @@
+#ifndef JSON_STREAM_WRITER_H
+#define JSON_STREAM_WRITER_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonWriter.h>
+
+// for the data
+#include <QString>
+#include <QIODevice>
+#include <QScopedPointer>
+
+// for writing any integer
+#include <type_traits>
+
+namespace JSON
+{
+    // internal data
+    class JsonStreamWriterPrivate;
+
+    /**
+     * \brief A writer that writes a document to an IO device as
+     *          it is described, without a `JsonValue` tree.
+     *
+     * Arrays and objects are opened and closed with calls, and
+     * everything in between is written as soon as it is given,
+     * through a buffer, so the memory used stays the same however
+     * large the document gets. This suits exports made straight
+     * from a database cursor:
+     *
+     *     JSON::JsonStreamWriter writer(&file);
+     *     writer.beginArray();
+     *     while (query.next()) {
+     *         writer.beginObject();
+     *         writer.key("id");
+     *         writer.value(query.value(0).toLongLong());
+     *         writer.key("name");
+     *         writer.value(query.value(1).toString());
+     *         writer.endObject();
+     *     }
+     *     writer.endArray();
+     *     writer.finish();
+     *
+     * The text is laid out and escaped the same way `JsonWriter`
+     * does it, with the same options. A call that would make the
+     * text invalid, such as a value where an object needs a key,
+     * writes nothing and returns `false`, as does every call
+     * made without a device.
+     *
+     * Once a value at the top level is finished, another can be
+     * started; each one after the first goes on a new line, so in
+     * `JsonWriter::CompactFormat` this writes JSON Lines.
+     */
+    class JSON_LIBRARY JsonStreamWriter
+    {
+        public:
+            /**
+             * \brief Construct a writer without a device.
+             */
+            JsonStreamWriter();
+
+            /**
+             * \brief Construct a writer that writes to `io`.
+             *
+             * \param[out] io The device to write to; it must
+             *              already be open.
+             */
+            explicit JsonStreamWriter(QIODevice* io);
+
+            /**
+             * \brief Destroy this object, calling `finish()` first.
+             */
+            ~JsonStreamWriter();
+
+            /**
+             * \brief Get the device written to.
+             *
+             * \returns The device, or `nullptr` if there is none.
+             */
+            auto getDevice() const -> QIODevice*;
+
+            /**
+             * \brief Set the device to write to, calling
+             *          `finish()` on the one before it first.
+             *
+             * \param[out] io The device to write to.
+             */
+            auto setDevice(QIODevice* io) -> void;
+
+            /**
+             * \brief Get how the text written is compressed.
+             *
+             * \returns The compression used.
+             */
+            auto getCompression() const -> JsonWriter::Compression;
+
+            /**
+             * \brief Set how the text written is compressed.
+             *
+             * A document that has already been started keeps the
+             * compression it was started with until `finish()`.
+             *
+             * \param[in] compression The compression to use. The
+             *              default is `JsonWriter::NoCompression`.
+             */
+            auto setCompression(JsonWriter::Compression compression) -> void;
+
+            /**
+             * \brief Get how the text is laid out.
+             *
+             * \returns The format used.
+             */
+            auto getFormat() const -> JsonWriter::Format;
+
+            /**
+             * \brief Set how the text is laid out.
+             *
+             * \param[in] format The format to use. The default
+             *              is `JsonWriter::IndentedFormat`.
+             */
+            auto setFormat(JsonWriter::Format format) -> void;
+
+            /**
+             * \brief Get how far each level is indented.
+             *
+             * \returns The number of spaces to a level,
+             *          or 0 for a tab.
+             */
+            auto getIndentation() const -> int;
+
+            /**
+             * \brief Set how far each level is indented in
+             *          `JsonWriter::IndentedFormat`.
+             *
+             * \param[in] spaces The number of spaces to a level,
+             *              or 0 to indent with a tab (the default).
+             */
+            auto setIndentation(int spaces) -> void;
+
+            /**
+             * \brief Get how long an array or object written on
+             *          a single line can be.
+             *
+             * \returns The number of characters, or 0 if arrays
+             *          and objects are never put on a single line.
+             */
+            auto getLineWidth() const -> int;
+
+            /**
+             * \brief Set how long an array or object written on
+             *          a single line can be.
+             *
+             * This works as it does for `JsonWriter`, but only for
+             * arrays and objects passed to `value()` whole; the
+             * size of one that is begun and ended with calls is not
+             * known until it is over.
+             *
+             * \param[in] width The number of characters, or 0 to
+             *              never put an array or object on a
+             *              single line (the default).
+             */
+            auto setLineWidth(int width) -> void;
+
+            /**
+             * \brief Start an array.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto beginArray() -> bool;
+
+            /**
+             * \brief End the innermost array.
+             *
+             * \returns `false` if the innermost value being
+             *          written is not an array, `true` otherwise.
+             */
+            auto endArray() -> bool;
+
+            /**
+             * \brief Start an object.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto beginObject() -> bool;
+
+            /**
+             * \brief End the innermost object.
+             *
+             * \returns `false` if the innermost value being
+             *          written is not an object, or if its last
+             *          key has no value, `true` otherwise.
+             */
+            auto endObject() -> bool;
+
+            /**
+             * \brief Write the key of the next value in an object.
+             *
+             * \param[in] key The key.
+             *
+             * \returns `false` if the innermost value being
+             *          written is not an object, or if the key
+             *          before this one has no value, `true`
+             *          otherwise.
+             */
+            auto key(const QString& key) -> bool;
+
+            /**
+             * \brief Write a value, arrays and objects included.
+             *
+             * \param[in] value The value to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(const JsonValue& value) -> bool;
+
+            /**
+             * \brief Write a string.
+             *
+             * \param[in] string The string to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(const QString& string) -> bool;
+
+            /**
+             * \brief Write a string of UTF-8 text.
+             *
+             * \param[in] string The string to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(const char* string) -> bool;
+
+            /**
+             * \brief Write a number.
+             *
+             * \param[in] number The number to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(double number) -> bool;
+
+            /**
+             * \brief Write an integer, digit for digit.
+             *
+             * \param[in] number The number to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(qint64 number) -> bool;
+
+            /**
+             * \brief Write an unsigned integer, digit for digit,
+             *          including those past the range of `qint64`.
+             *
+             * \param[in] number The number to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(quint64 number) -> bool;
+
+            /**
+             * \brief Write an integer of any other type, digit
+             *          for digit.
+             *
+             * This picks the signed or unsigned `value()` by the
+             * type, so that `int`, `uint`, `long` and the like
+             * are not ambiguous between the two and `double`.
+             *
+             * \param[in] number The number to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            template <class Integer>
+            auto value(Integer number) -> typename std::enable_if<
+                std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value,
+                bool>::type {
+                if (std::is_signed<Integer>::value) {
+                    return value(qint64(number));
+                }
+                return value(quint64(number));
+            }
+
+            /**
+             * \brief Write a boolean.
+             *
+             * \param[in] boolean The boolean to write.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto value(bool boolean) -> bool;
+
+            /**
+             * \brief Write null.
+             *
+             * \returns `false` if a value can't go here,
+             *          `true` otherwise.
+             */
+            auto nullValue() -> bool;
+
+            /**
+             * \brief Get how deep the writer is.
+             *
+             * \returns The number of arrays and objects
+             *          begun but not ended yet.
+             */
+            auto depth() const -> int;
+
+            /**
+             * \brief Pass what is buffered on to the device.
+             *
+             * Compressed text is passed on to the compressor,
+             * which holds on to some of it until `finish()`.
+             */
+            auto flush() -> void;
+
+            /**
+             * \brief Write out everything, ending the compressed
+             *          stream if there is one.
+             *
+             * Afterwards, the writer starts over on a new document
+             * on the same device. Any arrays and objects still open
+             * are left that way.
+             *
+             * \returns `false` if an array or object was still
+             *          open, `true` otherwise.
+             */
+            auto finish() -> bool;
+
+        private:
+            Q_DISABLE_COPY(JsonStreamWriter)
+
+            QScopedPointer<JsonStreamWriterPrivate> d;
+    };
+}
+
+#endif // JSON_STREAM_WRITER_H
@@ -0,0 +1,247 @@
+#ifndef JSON_TOKEN_READER_H
+#define JSON_TOKEN_READER_H
+
+// for the library
+#include <JsonDataTree/JsonForwards.h>
+#include <JsonDataTree/LibraryMacros.h>
+#include <JsonDataTree/JsonReader.h>
+
+// for implicit sharing
+#include <QSharedDataPointer>
+
+// for reading the data
+#include <QIODevice>
+#include <QString>
+
+namespace JSON
+{
+    // internal data
+    class JsonTokenReaderPrivate;
+
+    /**
+     * \brief A pull parser that reads a document one token
+     *          at a time.
+     *
+     * Each call to `next()` reads one more token, so the caller
+     * decides how much of the document to look at; it can stop
+     * at any time, and whole arrays and objects can be passed
+     * over with `skipValue()`. No `JsonValue`s are built.
+     *
+     * The tokens are read with the same code as `JsonReader`,
+     * and the same mistakes are reported as the same errors.
+     * After an error, `next()` keeps returning `Invalid`.
+     */
+    class JSON_LIBRARY JsonTokenReader
+    {
+        public:
+            /**
+             * \brief The kinds of tokens.
+             */
+            enum TokenType {
+                /** `next()` has not been called yet. */
+                NoToken = 0,
+                /** The `{` of an object. */
+                StartObject,
+                /** The `}` of an object. */
+                EndObject,
+                /** The `[` of an array. */
+                StartArray,
+                /** The `]` of an array. */
+                EndArray,
+                /** The key of the next value in an object. */
+                Key,
+                /** A string value. */
+                String,
+                /** A number. */
+                Number,
+                /** `true` or `false`. */
+                Boolean,
+                /** `null`. */
+                Null,
+                /** The whole value has been read. */
+                EndOfDocument,
+                /** There was an error; see `errors()`. */
+                Invalid
+            };
+
+            /**
+             * \brief Construct a reader with nothing to read.
+             */
+            JsonTokenReader();
+
+            /**
+             * \brief Construct a reader for the given text.
+             *
+             * \param[in] text The JSON text to read.
+             */
+            JsonTokenReader(QString text);
+
+            /**
+             * \brief Construct a reader for the rest of
+             *          the given IO device.
+             *
+             * The data is read the same way as it is by
+             * `JsonReader::read()`, and the offsets are the same.
+             *
+             * UTF-8 text is read from the device a piece at a
+             * time, as the tokens get to it, so a caller that
+             * stops early never reads the rest, and only about as
+             * much is held at once as the longest token or skipped
+             * value. A mistake can make the reader read on a little
+             * before it is reported. UTF-16 and UTF-32 text is
+             * still read all at once.
+             *
+             * The device has to stay open until the reader is done
+             * with it, and copies of the reader share it, so only
+             * one of them should go on reading.
+             *
+             * \param[in] io The IO device to read from.
+             */
+            JsonTokenReader(QIODevice* io);
+
+            /**
+             * \brief Make a copy of `other`, which
+             *          continues from the same token.
+             *
+             * \param[in] other The reader to copy.
+             */
+            JsonTokenReader(const JsonTokenReader& other);
+
+            /**
+             * \brief Destroy this object.
+             */
+            ~JsonTokenReader();
+
+            /**
+             * \brief Make this reader a copy of `other`.
+             *
+             * \param[in] other The reader to copy.
+             */
+            auto operator= (const JsonTokenReader& other) -> JsonTokenReader&;
+
+            /**
+             * \brief Read the next token.
+             *
+             * \returns The type of the token.
+             */
+            auto next() -> TokenType;
+
+            /**
+             * \brief Skip the rest of the current value.
+             *
+             * If the current token is `StartObject` or `StartArray`,
+             * this skips to the matching `EndObject` or `EndArray`,
+             * which becomes the current token. If it is a `Key`, the
+             * value that goes with the key is skipped. Otherwise,
+             * nothing happens.
+             *
+             * Arrays and objects are skipped by matching up brackets
+             * and braces only (strings and comments are still passed
+             * over properly), so mistakes inside of them are not
+             * noticed.
+             *
+             * \returns `true` if the value was skipped,
+             *          `false` if there was an error.
+             */
+            auto skipValue() -> bool;
+
+            /**
+             * \brief Get the type of the current token.
+             *
+             * \returns The type of the current token.
+             */
+            auto tokenType() const -> TokenType;
+
+            /**
+             * \brief Get the text of the current token.
+             *
+             * For `Key` and `String` tokens, this is the string
+             * with the escapes decoded. For `Number`, `Boolean`
+             * and `Null` tokens, it is the token as written.
+             *
+             * \returns The text of the current token.
+             */
+            auto toString() const -> QString;
+
+            /**
+             * \brief Get the value of the current `Number` token.
+             *
+             * \returns The number, or `0` if the
+             *          token is not a number.
+             */
+            auto toDouble() const -> double;
+
+            /**
+             * \brief Check if the current token is a `Number`
+             *          written without a fraction or exponent
+             *          that fits in 64 bits.
+             *
+             * \returns `true` if `toInt64()` or `toUInt64()`
+             *          give the number exactly.
+             */
+            auto isInteger() const -> bool;
+
+            /**
+             * \brief Get the value of the current `Number` token
+             *          as a 64-bit integer.
+             *
+             * A number a `qint64` can't hold exactly is rounded
+             * toward zero and held to its range, with NaN as `0`.
+             *
+             * \returns The number, or `0` if the
+             *          token is not a number.
+             */
+            auto toInt64() const -> qint64;
+
+            /**
+             * \brief Get the value of the current `Number` token
+             *          as an unsigned 64-bit integer.
+             *
+             * A number a `quint64` can't hold exactly is rounded
+             * toward zero and held to its range, with NaN and
+             * negative numbers as `0`.
+             *
+             * \returns The number, or `0` if the
+             *          token is not a number.
+             */
+            auto toUInt64() const -> quint64;
+
+            /**
+             * \brief Get the value of the current `Boolean` token.
+             *
+             * \returns The value, or `false` if the
+             *          token is not a boolean.
+             */
+            auto toBoolean() const -> bool;
+
+            /**
+             * \brief Get where the current token starts.
+             *
+             * \returns The offset of the current token.
+             */
+            auto offset() const -> int;
+
+            /**
+             * \brief Get the number of arrays and objects
+             *          the current token is inside of.
+             *
+             * Start tokens count themselves, and end tokens
+             * do not.
+             *
+             * \returns The depth of the current token.
+             */
+            auto depth() const -> int;
+
+            /**
+             * \brief Get the errors that occured.
+             *
+             * \returns The errors so far.
+             */
+            auto errors() const -> JsonReaderErrors;
+
+        private:
+            QSharedDataPointer<JsonTokenReaderPrivate> d;
+    };
+}
+
+#endif // JSON_TOKEN_READER_H
@@ -17,6 +17,8 @@ namespace JSON
 {
     // internal data class
     class JsonValuePrivate;
+    class JsonLazySpan;
+    class JsonLazyText;
 
     /**
      * \brief Describes a JSON value, i.e.
@@ -39,6 +41,12 @@ namespace JSON
         Q_PROPERTY(int integer
                    READ toInteger
                    WRITE setInteger)
+        Q_PROPERTY(bool isInteger
+                   READ isInteger
+                   STORED false)
+        Q_PROPERTY(qint64 int64
+                   READ toInt64
+                   WRITE setInt64)
         Q_PROPERTY(double floating
                    READ toDouble
                    WRITE setDouble)
@@ -138,6 +146,38 @@ namespace JSON
              */
             auto setInteger(int val) -> void;
 
+            /**
+             * \brief Make from a 64-bit integer value, which
+             *            is kept exactly.
+             *
+             * \param[in] val The value to assign to the object.
+             */
+            JsonValue(qint64 val);
+
+            /**
+             * \brief Assign a 64-bit integer value to this
+             *            `JsonValue`, which is kept exactly.
+             *
+             * \param[in] val The value to assign to this object.
+             */
+            auto setInt64(qint64 val) -> void;
+
+            /**
+             * \brief Make from an unsigned 64-bit integer value,
+             *            which is kept exactly.
+             *
+             * \param[in] val The value to assign to the object.
+             */
+            JsonValue(quint64 val);
+
+            /**
+             * \brief Assign an unsigned 64-bit integer value to
+             *            this `JsonValue`, which is kept exactly.
+             *
+             * \param[in] val The value to assign to this object.
+             */
+            auto setUInt64(quint64 val) -> void;
+
             /**
              * \brief Make from a floating point (`double`) value.
              *
@@ -288,6 +328,64 @@ namespace JSON
              */
             auto toDouble(bool* ok = nullptr) const -> double;
 
+            /**
+             * \brief Determine if this is a number kept
+             *            exactly as an integer.
+             *
+             * Numbers read without a fraction or exponent are
+             * integers when they fit in 64 bits, as are numbers
+             * made from any of the integer types.
+             *
+             * \see toInt64(bool*)
+             * \see toUInt64(bool*)
+             *
+             * \returns `true` if this is an integer,
+             *            `false` otherwise.
+             */
+            auto isInteger() const -> bool;
+
+            /**
+             * \brief Convert this value to a 64-bit integer.
+             *
+             * A number a `qint64` holds exactly is returned as it
+             * is. Other numbers are rounded toward zero and held to
+             * the range of a `qint64`, with NaN as `0`.
+             *
+             * If this is not a numeric value, this
+             * returns `0` and sets `*ok` to `false`.
+             *
+             * \see isInteger()
+             *
+             * \param[out] ok A flag set to `true` if this is a
+             *                number a `qint64` holds exactly,
+             *                `false` otherwise.
+             *
+             * \returns This value as a 64-bit integer.
+             */
+            auto toInt64(bool* ok = nullptr) const -> qint64;
+
+            /**
+             * \brief Convert this value to an unsigned
+             *            64-bit integer.
+             *
+             * A number a `quint64` holds exactly is returned as it
+             * is. Other numbers are rounded toward zero and held to
+             * the range of a `quint64`, with NaN and negative
+             * numbers as `0`.
+             *
+             * If this is not a numeric value, this
+             * returns `0` and sets `*ok` to `false`.
+             *
+             * \see isInteger()
+             *
+             * \param[out] ok A flag set to `true` if this is a
+             *                number a `quint64` holds exactly,
+             *                `false` otherwise.
+             *
+             * \returns This value as an unsigned 64-bit integer.
+             */
+            auto toUInt64(bool* ok = nullptr) const -> quint64;
+
             /**
              * \brief Determine if this is a string value.
              *
@@ -302,7 +400,9 @@ namespace JSON
              * \brief Convert this value to a string.
              *
              * If `isString()`, this simply returns the
-             * proper value.
+             * proper value. A string read by a zero-copy
+             * `JsonReader` is decoded from the text it was
+             * read from each time this is called.
              *
              * If this is not a string value, this
              * returns `QString()` and sets `*ok` to `false`.
@@ -546,6 +646,21 @@ namespace JSON
             auto create(JsonPath path, bool* ok = nullptr) -> JsonValue&;
 
         private:
+            friend class JsonLazySpan;
+            friend class JsonLazyText;
+
+            /**
+             * \brief Make an array or object that is read from
+             *            `span` when it is first used.
+             */
+            JsonValue(Type type, JsonLazySpan* span);
+
+            /**
+             * \brief Make a string that is left in `text`, at
+             *            `offset`, until it is used.
+             */
+            JsonValue(JsonLazyText* text, int offset, int length);
+
             /** \brief The *d-pointer* for this object. */
             QSharedDataPointer<JsonValuePrivate> d;
     };
@@ -16,6 +16,12 @@
 #include <QTextStream>
 #include <QIODevice>
 #include <QString>
+#include <QByteArray>
+
+// for writing in the background
+#include <QFuture>
+
+class QThreadPool;
 
 namespace JSON
 {
@@ -30,14 +36,64 @@ namespace JSON
 	{
 		Q_OBJECT
 
+		Q_ENUMS(Compression Format)
+
 		Q_PROPERTY(JsonValue data
 					READ getData
 					WRITE setData)
+		Q_PROPERTY(Compression compression
+					READ getCompression
+					WRITE setCompression)
+		Q_PROPERTY(Format format
+					READ getFormat
+					WRITE setFormat)
+		Q_PROPERTY(int indentation
+					READ getIndentation
+					WRITE setIndentation)
+		Q_PROPERTY(int lineWidth
+					READ getLineWidth
+					WRITE setLineWidth)
 		Q_PROPERTY(QString string
 					READ string
 					STORED false)
 
 		public:
+			/**
+			 * \brief How the text written to an IO device
+			 *			is compressed.
+			 */
+			enum Compression {
+				/**
+				 * Write the text as it is.
+				 */
+				NoCompression = 0,
+				/**
+				 * Write it in the gzip format, as a `.gz` file.
+				 */
+				GzipCompression,
+				/**
+				 * Write it in the zlib format.
+				 */
+				ZlibCompression
+			};
+
+			/**
+			 * \brief How the text is laid out.
+			 */
+			enum Format {
+				/**
+				 * Put each value in an array or object on a line
+				 * of its own, indented a level further than the
+				 * array or object.
+				 */
+				IndentedFormat = 0,
+				/**
+				 * Leave out all white space, for text that only
+				 * other programs will read.
+				 */
+				CompactFormat
+			};
+
 			/**
 			 * \brief Construct a JSON writer
 			 *			with null data.
@@ -86,6 +142,106 @@ namespace JSON
 			 */
 			auto setData(JsonValue data) -> void;
 
+			/**
+			 * \brief Get how text written to an IO device
+			 *			is compressed.
+			 *
+			 * \returns The compression used.
+			 */
+			auto getCompression() const -> Compression;
+
+			/**
+			 * \brief Set how text written to an IO device
+			 *			is compressed.
+			 *
+			 * The text is compressed on a thread of its own while
+			 * it is written out, a piece at a time, so the whole of
+			 * it is never held at once. `JsonReader` recognizes
+			 * either format when it reads the text back in. Strings
+			 * and text streams are always written uncompressed.
+			 *
+			 * \param[in] compression The compression to use. The
+			 *				default is `NoCompression`.
+			 */
+			auto setCompression(Compression compression) -> void;
+
+			/**
+			 * \brief Get how the text is laid out.
+			 *
+			 * \returns The format used.
+			 */
+			auto getFormat() const -> Format;
+
+			/**
+			 * \brief Set how the text is laid out.
+			 *
+			 * \param[in] format The format to use. The default
+			 *				is `IndentedFormat`.
+			 */
+			auto setFormat(Format format) -> void;
+
+			/**
+			 * \brief Get how far each level is indented.
+			 *
+			 * \returns The number of spaces to a level,
+			 *			or 0 for a tab.
+			 */
+			auto getIndentation() const -> int;
+
+			/**
+			 * \brief Set how far each level is indented in
+			 *			`IndentedFormat`.
+			 *
+			 * \param[in] spaces The number of spaces to a level,
+			 *				or 0 to indent with a tab (the default).
+			 */
+			auto setIndentation(int spaces) -> void;
+
+			/**
+			 * \brief Get how long an array or object written on
+			 *			a single line can be.
+			 *
+			 * \returns The number of characters, or 0 if arrays
+			 *			and objects are never put on a single line.
+			 */
+			auto getLineWidth() const -> int;
+
+			/**
+			 * \brief Set how long an array or object written on
+			 *			a single line can be.
+			 *
+			 * In `IndentedFormat`, an array or object that takes up
+			 * no more than `width` characters when written out on a
+			 * single line, as in `[1, 2, 3]` or `{"x": 1, "y": 2}`,
+			 * is written that way rather than spread out over
+			 * several. Only the array or object itself is counted,
+			 * not the indentation or the key before it. This is
+			 * meant for short arrays and objects, such as points
+			 * or small lists, in text that people read.
+			 *
+			 * \param[in] width The number of characters, or 0 to
+			 *				never put an array or object on a
+			 *				single line (the default).
+			 */
+			auto setLineWidth(int width) -> void;
+
+			/**
+			 * \brief Get the pool asynchronous writes are run on.
+			 *
+			 * \returns The thread pool, or `nullptr` for
+			 *			`QThreadPool::globalInstance()`.
+			 */
+			auto getThreadPool() const -> QThreadPool*;
+
+			/**
+			 * \brief Set the pool asynchronous writes are run on.
+			 *
+			 * \param[in] pool The thread pool to use, or `nullptr`
+			 *				for `QThreadPool::globalInstance()` (the
+			 *				default).
+			 */
+			auto setThreadPool(QThreadPool* pool) -> void;
+
 			/**
 			 * \brief Get the data as a string.
 			 *
@@ -93,6 +249,17 @@ namespace JSON
 			 */
 			auto string() const -> QString;
 
+			/**
+			 * \brief Get the data as UTF-8 text.
+			 *
+			 * The text is put together in the byte array directly,
+			 * without going through a `QString` or `QTextStream`
+			 * first, so this is the fastest way to get it.
+			 *
+			 * \returns The data as UTF-8 text.
+			 */
+			auto toUtf8() const -> QByteArray;
+
 			/**
 			 * \brief Write the data to a string.
 			 *
@@ -101,7 +268,23 @@ namespace JSON
 			auto writeTo(QString* str) const -> void;
 
 			/**
-			 * \brief Write the data to an IO device.
+			 * \brief Append the data to a byte array as
+			 *			UTF-8 text.
+			 *
+			 * This works like `toUtf8()`, but adds to what is already
+			 * in `bytes`, so an array that is reused keeps the room
+			 * it has.
+			 *
+			 * \param[out] bytes The byte array to append to.
+			 */
+			auto writeTo(QByteArray* bytes) const -> void;
+
+			/**
+			 * \brief Write the data to an IO device,
+			 *			compressed if so set.
+			 *
+			 * The text is always UTF-8, written a buffer full at a
+			 * time, whatever the locale.
 			 *
 			 * \param[out] io The device to write to.
 			 */
@@ -114,6 +297,51 @@ namespace JSON
 			 */
 			auto writeTo(QTextStream& stream) const -> void;
 
+			/**
+			 * \brief Write the data to a file on the thread pool.
+			 *
+			 * The file is written the way `writeTo(QIODevice*)`
+			 * writes to a device, with the data and compression as
+			 * they are now, on the writer's thread pool. This returns
+			 * right away, so the calling thread's event loop keeps
+			 * running while the data is written.
+			 *
+			 * The future's progress is the number of values in the
+			 * top-level array or object written so far, out of all
+			 * of them. Canceling the future stops the writer before
+			 * the next of them.
+			 *
+			 * The data is written to a temporary file next to the
+			 * one at `path`, and only replaces it once all of the
+			 * data has been written, so a canceled or failed write
+			 * leaves the file as it was. If the file cannot be
+			 * opened or written, the future is canceled; once it
+			 * has finished, `isCanceled()` tells if the write failed.
+			 *
+			 * \param[in] path The path of the file to write; it is
+			 *				replaced if it is there already.
+			 *
+			 * \returns A future that finishes once the data has
+			 *			been written.
+			 */
+			auto writeToAsync(QString path) const -> QFuture<void>;
+
+			/**
+			 * \brief Write the data to an IO device on the
+			 *			thread pool.
+			 *
+			 * This works like `writeToAsync(QString)`. The device is
+			 * written to from the pool, so it must not be used in
+			 * the meantime, and must be one that can be used from
+			 * another thread, such as a file or a buffer.
+			 *
+			 * \param[out] io The device to write to.
+			 *
+			 * \returns A future that finishes once the data has
+			 *			been written.
+			 */
+			auto writeToAsync(QIODevice* io) const -> QFuture<void>;
+
 		private:
 			QSharedDataPointer<JsonWriterPrivate> d;
 	};
@@ -9,9 +9,30 @@ INCLUDEPATH += .
 CONFIG += release
 
 # Input
-HEADERS += 
-SOURCES += src/JsonPath.cpp \
+HEADERS += src/JsonCompression_p.h \
+           src/JsonDocument_p.h \
+           src/JsonKeyCache_p.h \
+           src/JsonLazyValue_p.h \
+           src/JsonLexer_p.h \
+           src/JsonNumberFormat_p.h \
+           src/JsonReader_p.h \
+           src/JsonStructuralIndex_p.h \
+           src/JsonTreeBuilder_p.h \
+           src/JsonWriter_p.h
+SOURCES += src/JsonCompression.cpp \
+           src/JsonDocument.cpp \
+           src/JsonHandler.cpp \
+           src/JsonKeyTable.cpp \
+           src/JsonLazyValue.cpp \
+           src/JsonLinesReader.cpp \
+           src/JsonNumberFormat.cpp \
+           src/JsonPath.cpp \
            src/JsonReader.cpp \
+           src/JsonReaderSession.cpp \
+           src/JsonStreamReader.cpp \
+           src/JsonStreamWriter.cpp \
+           src/JsonStructuralIndex.cpp \
+           src/JsonTokenReader.cpp \
            src/JsonValue.cpp \
            src/JsonWriter.cpp
 
@@ -19,6 +40,7 @@ SOURCES += src/JsonPath.cpp \
 
 CONFIG += c++11
 DEFINES *= MAKE_JSON_LIBRARY QT_USE_STRINGBUILDER
+LIBS += -lz
 macx:QMAKE_CXXFLAGS += -mmacosx-version-min=10.7 -std=gnu0x -stdlib=libc+
 
 # This gets the include path
@@ -35,6 +57,14 @@ HEADERS +=  $${JSON_LIBRARY_PATH}JsonDataTree/LibraryMacros.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonValue.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonObject.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonArray.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonHandler.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonReader.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonReaderSession.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonDocument.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonKeyTable.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonTokenReader.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonStreamReader.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonLinesReader.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonWriter.h \
+            $${JSON_LIBRARY_PATH}JsonDataTree/JsonStreamWriter.h \
             $${JSON_LIBRARY_PATH}JsonDataTree/JsonPath.h
@@ -0,0 +1,394 @@
+// header file
+#include "JsonCompression_p.h"
+
+// internal data
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <cstring>
+
+// for the formats themselves
+#include <zlib.h>
+
+using namespace JSON;
+
+// runs zlib over the chunks a device hands it, and hands back what
+// comes out; only a few chunks are waiting on either side at a time,
+// so each side works on one while the other side works on the next
+class JSON::JsonCodecThread : public QThread {
+	public:
+		// what `take()` found
+		enum Taken {
+			Output,
+			Hungry,             // nothing yet, and no input to work on
+			Ended
+		};
+
+		static const int chunkSize = 1 << 16;
+		// the most chunks waiting to be worked on, and the most
+		// inflated chunks waiting to be read
+		static const int depth = 2;
+
+		JsonCodecThread(bool deflating, int windowBits)
+			:	deflating(deflating), streamEnded(false), ignoring(false),
+				used(0), finished(false), ended(false), stopping(false),
+				failed(false), produced(0) {
+			stream.zalloc = Z_NULL;
+			stream.zfree = Z_NULL;
+			stream.opaque = Z_NULL;
+			stream.next_in = Z_NULL;
+			stream.avail_in = 0;
+			int ans = deflating
+				? deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+							   windowBits, 8, Z_DEFAULT_STRATEGY)
+				: inflateInit2(&stream, windowBits);
+			if (ans != Z_OK) {
+				// there is nothing to run, so it ends right away
+				ended = failed = true;
+			}
+		}
+
+		~JsonCodecThread() {
+			{
+				QMutexLocker lock(&mutex);
+				stopping = true;
+				changed.wakeAll();
+			}
+			wait();
+			if (deflating) {
+				deflateEnd(&stream);
+			} else {
+				inflateEnd(&stream);
+			}
+		}
+
+		// whether another chunk of input would be worked on
+		// without having to wait
+		auto hungry() -> bool {
+			QMutexLocker lock(&mutex);
+			return !finished && !ended && inputs.size() < depth;
+		}
+
+		// hand over a chunk, waiting for room if there is none
+		auto put(const QByteArray& input) -> void {
+			QMutexLocker lock(&mutex);
+			while (inputs.size() >= depth && !ended) {
+				changed.wait(&mutex);
+			}
+			if (!ended) {
+				inputs.enqueue(input);
+				changed.wakeAll();
+			}
+		}
+
+		// there is no more input
+		auto finish() -> void {
+			QMutexLocker lock(&mutex);
+			finished = true;
+			changed.wakeAll();
+		}
+
+		// the next chunk of output; with `wait`, this only comes
+		// back empty handed if more input is needed first
+		auto take(QByteArray& output, bool wait) -> Taken {
+			QMutexLocker lock(&mutex);
+			while (true) {
+				if (!outputs.isEmpty()) {
+					output = outputs.dequeue();
+					changed.wakeAll();
+					return Output;
+				}
+				if (ended) {
+					return Ended;
+				}
+				if (!wait || (inputs.isEmpty() && !finished)) {
+					return Hungry;
+				}
+				changed.wait(&mutex);
+			}
+		}
+
+		auto hasFailed() -> bool {
+			QMutexLocker lock(&mutex);
+			return failed;
+		}
+
+		auto amountProduced() -> qint64 {
+			QMutexLocker lock(&mutex);
+			return produced;
+		}
+
+	protected:
+		auto run() -> void override {
+			while (true) {
+				QByteArray input;
+				bool last;
+				{
+					QMutexLocker lock(&mutex);
+					while (inputs.isEmpty() && !finished && !stopping && !ended) {
+						changed.wait(&mutex);
+					}
+					if (stopping || ended) {
+						return;
+					}
+					last = inputs.isEmpty();
+					if (!last) {
+						input = inputs.dequeue();
+						changed.wakeAll();
+					}
+				}
+				bool ok = code(input, last);
+				if (!ok || last) {
+					QMutexLocker lock(&mutex);
+					failed = !ok && !stopping;
+					ended = true;
+					inputs.clear();
+					changed.wakeAll();
+					return;
+				}
+			}
+		}
+
+	private:
+		// run one chunk through zlib; this is `false` if the
+		// stream is broken, or the device is going away
+		auto code(const QByteArray& input, bool last) -> bool {
+			stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()));
+			stream.avail_in = ignoring ? 0 : uInt(input.size());
+			while (true) {
+				if (out.isEmpty()) {
+					out.resize(chunkSize);
+					used = 0;
+				}
+				stream.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+				stream.avail_out = uInt(chunkSize - used);
+				int ans;
+				if (deflating) {
+					ans = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+				} else {
+					if (streamEnded) {
+						if (stream.avail_in == 0) {
+							break;
+						}
+						// a gzip file can be several streams one after
+						// another; anything else after the end is
+						// ignored, as gzip itself does
+						if (*stream.next_in != 0x1f) {
+							ignoring = true;
+							break;
+						}
+						inflateReset(&stream);
+						streamEnded = false;
+					}
+					ans = inflate(&stream, Z_NO_FLUSH);
+				}
+				used = chunkSize - int(stream.avail_out);
+				if (used == chunkSize && !hand()) {
+					return false;
+				}
+				if (ans == Z_STREAM_END) {
+					if (deflating) {
+						break;
+					}
+					streamEnded = true;
+					continue;
+				}
+				if (ans == Z_BUF_ERROR) {
+					// nothing more can be done with what is here
+					break;
+				}
+				if (ans != Z_OK) {
+					return broken();
+				}
+				if (stream.avail_in == 0 && stream.avail_out != 0
+						&& !(deflating && last)) {
+					break;
+				}
+			}
+			if (last) {
+				if (!deflating && !streamEnded) {
+					// cut short
+					return broken();
+				}
+				if (used > 0) {
+					return hand();
+				}
+			}
+			return true;
+		}
+
+		// hand out what came before a break in the stream, so
+		// it can be read up to there; this is always `false`
+		auto broken() -> bool {
+			if (used > 0) {
+				hand();
+			}
+			return false;
+		}
+
+		// hand out the chunk that has been filled
+		auto hand() -> bool {
+			out.resize(used);
+			QMutexLocker lock(&mutex);
+			// only inflated text is held back; compressed text is
+			// smaller than what went into it, and the device takes
+			// all of it each time it hands over more
+			while (!deflating && outputs.size() >= depth && !stopping) {
+				changed.wait(&mutex);
+			}
+			if (stopping) {
+				return false;
+			}
+			produced += used;
+			outputs.enqueue(out);
+			out = QByteArray();
+			used = 0;
+			changed.wakeAll();
+			return true;
+		}
+
+		// only used on this thread
+		z_stream stream;
+		bool deflating;
+		bool streamEnded;
+		// past the end of the last gzip stream
+		bool ignoring;
+		// the chunk being filled
+		QByteArray out;
+		int used;
+
+		// shared with the device
+		QMutex mutex;
+		QWaitCondition changed;
+		QQueue<QByteArray> inputs;
+		QQueue<QByteArray> outputs;
+		bool finished;
+		bool ended;
+		bool stopping;
+		bool failed;
+		qint64 produced;
+};
+
+JsonInflateDevice::JsonInflateDevice(QIODevice* source)
+	:	source(source),
+		// either format, whichever the header says
+		codec(new JsonCodecThread(false, MAX_WBITS + 32)),
+		pos(0) {
+	codec->start();
+	open(QIODevice::ReadOnly);
+}
+
+JsonInflateDevice::~JsonInflateDevice() { }
+
+auto JsonInflateDevice::isCompressed(QIODevice* io) -> bool {
+	return isCompressed(io->peek(2));
+}
+
+auto JsonInflateDevice::isCompressed(const QByteArray& header) -> bool {
+	if (header.size() < 2) {
+		return false;
+	}
+	uchar first = uchar(header.at(0));
+	uchar second = uchar(header.at(1));
+	if (first == 0x1f && second == 0x8b) {
+		return true;
+	}
+	// zlib: deflate with a window of at most 32 KB, no preset
+	// dictionary, and a check on the two bytes together
+	return (first & 0x0f) == 8 && (first >> 4) <= 7 && !(second & 0x20)
+		&& (first * 256 + second) % 31 == 0;
+}
+
+auto JsonInflateDevice::failed() const -> bool {
+	return codec->hasFailed();
+}
+
+auto JsonInflateDevice::inflated() const -> qint64 {
+	return codec->amountProduced();
+}
+
+auto JsonInflateDevice::isSequential() const -> bool {
+	return true;
+}
+
+auto JsonInflateDevice::readData(char* data, qint64 maxSize) -> qint64 {
+	while (pos >= chunk.size()) {
+		// keep the other thread supplied first, so it is never
+		// waiting on this one while this one waits on it
+		while (codec->hungry()) {
+			QByteArray more = source->read(JsonCodecThread::chunkSize);
+			if (more.isEmpty()) {
+				codec->finish();
+				break;
+			}
+			codec->put(more);
+		}
+		JsonCodecThread::Taken taken = codec->take(chunk, true);
+		if (taken == JsonCodecThread::Ended) {
+			chunk.clear();
+			pos = 0;
+			return -1;
+		}
+		if (taken == JsonCodecThread::Output) {
+			pos = 0;
+		}
+	}
+	qint64 size = qMin(maxSize, qint64(chunk.size() - pos));
+	std::memcpy(data, chunk.constData() + pos, size_t(size));
+	pos += int(size);
+	return size;
+}
+
+auto JsonInflateDevice::writeData(const char*, qint64) -> qint64 {
+	return -1;
+}
+
+JsonDeflateDevice::JsonDeflateDevice(QIODevice* target, bool gzip)
+	:	target(target),
+		codec(new JsonCodecThread(true, gzip ? MAX_WBITS + 16 : MAX_WBITS)) {
+	codec->start();
+	open(QIODevice::WriteOnly);
+}
+
+JsonDeflateDevice::~JsonDeflateDevice() {
+	close();
+}
+
+auto JsonDeflateDevice::close() -> void {
+	if (isOpen()) {
+		if (!pending.isEmpty()) {
+			codec->put(pending);
+			pending.clear();
+		}
+		codec->finish();
+		drain(true);
+	}
+	QIODevice::close();
+}
+
+auto JsonDeflateDevice::isSequential() const -> bool {
+	return true;
+}
+
+auto JsonDeflateDevice::readData(char*, qint64) -> qint64 {
+	return -1;
+}
+
+auto JsonDeflateDevice::writeData(const char* data, qint64 maxSize) -> qint64 {
+	pending.append(data, int(maxSize));
+	if (pending.size() >= JsonCodecThread::chunkSize) {
+		codec->put(pending);
+		pending.clear();
+		drain(false);
+	}
+	return maxSize;
+}
+
+auto JsonDeflateDevice::drain(bool wait) -> void {
+	QByteArray out;
+	while (codec->take(out, wait) == JsonCodecThread::Output) {
+		target->write(out);
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef JSON_COMPRESSION_P_H
+#define JSON_COMPRESSION_P_H
+
+// superclass
+#include <QIODevice>
+
+// for the data
+#include <QByteArray>
+#include <QScopedPointer>
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// the thread that runs zlib for one of the devices below
+class JsonCodecThread;
+
+// the text in a gzip or zlib stream; it is inflated on a thread of
+// its own while it is read, a chunk at a time, so the compressed
+// text is never held all at once. The stream is read from on the
+// thread that reads from this device, and only there.
+class JsonInflateDevice : public QIODevice {
+	public:
+		JsonInflateDevice(QIODevice* source);
+		~JsonInflateDevice();
+
+		// whether the text `io` is about to give is compressed;
+		// neither format can start with anything that is JSON
+		static auto isCompressed(QIODevice* io) -> bool;
+		// the same for text that starts with `header`
+		static auto isCompressed(const QByteArray& header) -> bool;
+
+		// whether the stream was cut short or corrupt, and how much
+		// text had been inflated when it was found to be
+		auto failed() const -> bool;
+		auto inflated() const -> qint64;
+
+		auto isSequential() const -> bool override;
+
+	protected:
+		auto readData(char* data, qint64 maxSize) -> qint64 override;
+		auto writeData(const char* data, qint64 maxSize) -> qint64 override;
+
+	private:
+		Q_DISABLE_COPY(JsonInflateDevice)
+
+		QIODevice* source;
+		QScopedPointer<JsonCodecThread> codec;
+		// the chunk being read, and how much of it has been
+		QByteArray chunk;
+		int pos;
+};
+
+// writes what is written to it to another device, compressed as gzip
+// or zlib on a thread of its own; it is all written once this is closed
+class JsonDeflateDevice : public QIODevice {
+	public:
+		JsonDeflateDevice(QIODevice* target, bool gzip);
+		~JsonDeflateDevice();
+
+		auto close() -> void override;
+
+		auto isSequential() const -> bool override;
+
+	protected:
+		auto readData(char* data, qint64 maxSize) -> qint64 override;
+		auto writeData(const char* data, qint64 maxSize) -> qint64 override;
+
+	private:
+		Q_DISABLE_COPY(JsonDeflateDevice)
+
+		// write out what has been compressed so far, or, with
+		// `wait`, everything up to the end of the stream
+		auto drain(bool wait) -> void;
+
+		QIODevice* target;
+		QScopedPointer<JsonCodecThread> codec;
+		// what has been written, but not handed over yet
+		QByteArray pending;
+};
+
+}
+
+#endif // JSON_COMPRESSION_P_H
@@ -0,0 +1,141 @@
+// header file
+#include <JsonDataTree/JsonDocument.h>
+
+// internal data
+#include "JsonDocument_p.h"
+#include <JsonDataTree/JsonArray.h>
+#include <JsonDataTree/JsonObject.h>
+
+using namespace JSON;
+
+// whether the characters can go through the key cache
+static auto isAscii(const ushort* chars, int length) -> bool {
+	for (int i = 0; i < length; ++ i) {
+		if (chars[i] >= 0x80) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// the key in `node`
+static auto keyOf(JsonArena& arena, const JsonNode& node) -> QString {
+	if (isAscii(node.chars, node.size)) {
+		return arena.keys.key(node.chars, node.size);
+	}
+	return QString(reinterpret_cast<const QChar*>(node.chars), node.size);
+}
+
+auto JsonArenaSpan::read() const -> JsonValue {
+	// arrays and objects are only read one at a time, so
+	// nothing else uses the key cache in the meantime
+	const JsonNode* children = node->children;
+	if (node->type == JsonValue::Object) {
+		JsonObject object;
+		object.reserve(node->size);
+		for (int i = 0; i < node->size; ++ i) {
+			object.insert(keyOf(*arena, children[2 * i]),
+						  value(arena, children + 2 * i + 1));
+		}
+		return object;
+	}
+	JsonArray array;
+	array.reserve(node->size);
+	for (int i = 0; i < node->size; ++ i) {
+		array.append(value(arena, children + i));
+	}
+	return array;
+}
+
+auto JsonArenaSpan::value(const QExplicitlySharedDataPointer<JsonArena>& arena,
+						  const JsonNode* node) -> JsonValue {
+	switch (node->type) {
+		case JsonValue::String:
+			return QString(reinterpret_cast<const QChar*>(node->chars), node->size);
+		case JsonValue::Number:
+			switch (node->kind) {
+				case JsonNumber::Signed:
+					return node->integer;
+				case JsonNumber::Unsigned:
+					return node->natural;
+				default:
+					return node->real;
+			}
+		case JsonValue::Boolean:
+			return node->boolean;
+		case JsonValue::Array:
+		case JsonValue::Object:
+			return later(JsonValue::Type(node->type), new JsonArenaSpan(arena, node));
+		default:
+			return JsonValue::Null;
+	}
+}
+
+JsonDocument::JsonDocument()
+	:	d(new JsonDocumentPrivate) { }
+
+JsonDocument::JsonDocument(JsonDocumentPrivate* d)
+	:	d(d) { }
+
+JsonDocument::~JsonDocument() { }
+
+JsonDocument::JsonDocument(const JsonDocument& other)
+	:	d(other.d) { }
+
+auto JsonDocument::operator= (const JsonDocument& other) -> JsonDocument& {
+	d = other.d;
+	return *this;
+}
+
+auto JsonDocument::root() const -> JsonValue {
+	return d->root;
+}
+
+auto JsonDocument::follow(JsonPath path, bool* ok) const -> JsonValue {
+	if (!d->node) {
+		return d->root.follow(path, ok);
+	}
+	const JsonNode* node = d->node;
+	// follow down the path
+	for (auto key : path) {
+		const JsonNode* next = nullptr;
+		if (node->type == JsonValue::Object && key.isObjectKey()) {
+			QString k = key.toObjectKey();
+			const ushort* chars = k.utf16();
+			// the last one with the key wins, as it does in an object
+			for (int i = node->size - 1; i >= 0 && !next; -- i) {
+				const JsonNode& member = node->children[2 * i];
+				if (member.size == k.length()
+						&& (member.size == 0
+							|| std::memcmp(member.chars, chars,
+										   size_t(member.size) * sizeof(ushort)) == 0)) {
+					next = node->children + 2 * i + 1;
+				}
+			}
+		} else if (node->type == JsonValue::Array && key.isArrayIndex()) {
+			int k = key.toArrayIndex();
+			if (k >= 0 && k < node->size) {
+				next = node->children + k;
+			}
+		}
+		if (!next) {
+			// not the right kind, or not there
+			if (ok) {
+				*ok = false;
+			}
+			return JsonValue::Null;
+		}
+		node = next;
+	}
+	if (ok) {
+		*ok = true;
+	}
+	if (node == d->node) {
+		return d->root;
+	}
+	return JsonArenaSpan::value(d->arena, node);
+}
+
+auto JsonDocument::memoryUsed() const -> qint64 {
+	return d->arena ? d->arena->used : 0;
+}
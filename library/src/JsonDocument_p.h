@@ -0,0 +1,378 @@
+#ifndef JSON_DOCUMENT_P_H
+#define JSON_DOCUMENT_P_H
+
+// for the data
+#include <JsonDataTree/JsonDocument.h>
+#include <JsonDataTree/JsonValue.h>
+#include <QSharedData>
+#include <QExplicitlySharedDataPointer>
+#include <QString>
+#include <QVector>
+#include <cstring>
+
+// for handing out values
+#include "JsonLazyValue_p.h"
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// one value of a document; these are plain data, so they can be
+// moved around with memcpy and are never destroyed one by one
+class JsonNode {
+	public:
+		// a JsonValue::Type
+		qint8 type;
+		// a JsonNumber::Kind, for numbers
+		qint8 kind;
+		// the characters in a string, the elements of an
+		// array, or the members of an object
+		int size;
+		union {
+			double real;
+			qint64 integer;
+			quint64 natural;
+			bool boolean;
+			const ushort* chars;
+			// for an object, each key comes right before its value
+			const JsonNode* children;
+		};
+};
+
+// the memory all of the nodes and strings of a document are in; it
+// only ever grows, and is freed all at once when it is destroyed
+class JsonArena : public JsonLazySource {
+	public:
+		// the first block; each one after that is twice as big
+		// as the one before, up to the largest size
+		static const int firstBlockSize = 1 << 14;
+		static const int largestBlockSize = 1 << 20;
+
+		JsonArena()
+			:	used(0), next(nullptr), end(nullptr) { }
+
+		~JsonArena() {
+			for (char* block : blocks) {
+				delete[] block;
+			}
+		}
+
+		// room for `count` objects of type `T`, which must be
+		// plain data, since they are never destroyed
+		template <class T>
+		auto allocate(int count) -> T* {
+			// everything stays aligned for the widest member of a node
+			size_t size = (size_t(count) * sizeof(T) + 7) & ~size_t(7);
+			if (size_t(end - next) < size) {
+				grow(size);
+			}
+			T* ans = reinterpret_cast<T*>(next);
+			next += size;
+			return ans;
+		}
+
+		// the number of bytes taken from the system
+		qint64 used;
+
+	private:
+		Q_DISABLE_COPY(JsonArena)
+
+		auto grow(size_t size) -> void {
+			size_t blockSize = blocks.isEmpty() ? size_t(firstBlockSize)
+												: size_t(end - blocks.last()) * 2;
+			if (blockSize > size_t(largestBlockSize)) {
+				blockSize = largestBlockSize;
+			}
+			if (blockSize < size) {
+				blockSize = size;
+			}
+			char* block = new char[blockSize];
+			blocks.append(block);
+			next = block;
+			end = block + blockSize;
+			used += qint64(blockSize);
+		}
+
+		QVector<char*> blocks;
+		// the free part of the last block
+		char* next;
+		char* end;
+};
+
+// builds the nodes out of the events the parser emits; the
+// values waiting for their array or object to end are kept
+// together on one stack, and copied into the arena in one
+// piece when it does
+class JsonArenaBuilder {
+	public:
+		JsonArenaBuilder(JsonArena* arena)
+			:	arena(arena) {
+			clear();
+		}
+
+		auto startObject() -> bool {
+			open.append(Open(true, pending.size()));
+			return true;
+		}
+
+		auto key(const QString& key) -> bool {
+			pending.append(text(key));
+			return true;
+		}
+
+		auto endObject() -> bool {
+			return close();
+		}
+
+		auto startArray() -> bool {
+			open.append(Open(false, pending.size()));
+			return true;
+		}
+
+		auto endArray() -> bool {
+			return close();
+		}
+
+		auto string(const QString& value) -> bool {
+			return add(text(value));
+		}
+
+		// a string without escapes, straight out of the text
+		auto plain(const ushort* start, int length) -> bool {
+			JsonNode node = scalar(JsonValue::String);
+			node.size = length;
+			ushort* chars = arena->allocate<ushort>(length);
+			if (length > 0) {
+				std::memcpy(chars, start, size_t(length) * sizeof(ushort));
+			}
+			node.chars = chars;
+			return add(node);
+		}
+
+		auto plain(const uchar* start, int length) -> bool {
+			int size = utf16Length(start, length);
+			if (size < 0) {
+				// leave anything out of the ordinary to Qt
+				return string(QString::fromUtf8(reinterpret_cast<const char*>(start), length));
+			}
+			JsonNode node = scalar(JsonValue::String);
+			node.size = size;
+			ushort* chars = arena->allocate<ushort>(size);
+			node.chars = chars;
+			for (const uchar* end = start + length; start < end; ) {
+				uint c = *start++;
+				if (c >= 0x80) {
+					int extra = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : 1;
+					c &= 0x3f >> extra;
+					for (; extra > 0; -- extra) {
+						c = c << 6 | (*start++ & 0x3f);
+					}
+					if (c >= 0x10000) {
+						*chars++ = ushort(0xd7c0 + (c >> 10));
+						c = 0xdc00 | (c & 0x3ff);
+					}
+				}
+				*chars++ = ushort(c);
+			}
+			return add(node);
+		}
+
+		auto number(double value) -> bool {
+			JsonNode node = scalar(JsonValue::Number);
+			node.kind = JsonNumber::Double;
+			node.real = value;
+			return add(node);
+		}
+
+		auto integer(qint64 value) -> bool {
+			JsonNode node = scalar(JsonValue::Number);
+			node.kind = JsonNumber::Signed;
+			node.integer = value;
+			return add(node);
+		}
+
+		auto unsignedInteger(quint64 value) -> bool {
+			JsonNode node = scalar(JsonValue::Number);
+			node.kind = JsonNumber::Unsigned;
+			node.natural = value;
+			return add(node);
+		}
+
+		auto boolean(bool value) -> bool {
+			JsonNode node = scalar(JsonValue::Boolean);
+			node.boolean = value;
+			return add(node);
+		}
+
+		auto null() -> bool {
+			return add(scalar(JsonValue::Null));
+		}
+
+		// the value read in, placed in the arena; if the parser
+		// stopped half way, this is the outermost array or object
+		// with the values that were finished in it
+		auto result() -> const JsonNode* {
+			if (!open.isEmpty()) {
+				int end = open.size() > 1 ? open.at(1).start : pending.size();
+				pending.resize(end);
+				open.resize(1);
+				if (open.first().isObject && (end - open.first().start) % 2) {
+					// a key with no value
+					pending.removeLast();
+				}
+				close();
+			}
+			JsonNode* node = arena->allocate<JsonNode>(1);
+			*node = root;
+			return node;
+		}
+
+		auto clear() -> void {
+			open.clear();
+			pending.clear();
+			root = scalar(JsonValue::Null);
+		}
+
+	private:
+		// an array or object that is still being read
+		class Open {
+			public:
+				Open(bool isObject = false, int start = 0)
+					:	isObject(isObject), start(start) { }
+
+				bool isObject;
+				// where its values start in `pending`
+				int start;
+		};
+
+		static auto scalar(JsonValue::Type type) -> JsonNode {
+			JsonNode node;
+			node.type = qint8(type);
+			node.kind = JsonNumber::Double;
+			node.size = 0;
+			node.natural = 0;
+			return node;
+		}
+
+		// a string, with its characters copied into the arena
+		auto text(const QString& value) -> JsonNode {
+			JsonNode node = scalar(JsonValue::String);
+			node.size = value.length();
+			ushort* chars = arena->allocate<ushort>(node.size);
+			if (node.size > 0) {
+				std::memcpy(chars, value.utf16(), size_t(node.size) * sizeof(ushort));
+			}
+			node.chars = chars;
+			return node;
+		}
+
+		// the number of UTF-16 characters in a run of UTF-8 text, or
+		// -1 if it is not plain well-formed UTF-8: invalid sequences,
+		// a byte order mark, and noncharacters are for Qt to deal with
+		static auto utf16Length(const uchar* text, int length) -> int {
+			int size = 0;
+			for (int i = 0; i < length; ) {
+				uint c = text[i];
+				if (c < 0x80) {
+					++ i;
+					++ size;
+					continue;
+				}
+				int extra = (c & 0xe0) == 0xc0 ? 1 : (c & 0xf0) == 0xe0 ? 2
+						  : (c & 0xf8) == 0xf0 ? 3 : 0;
+				if (extra == 0 || length - i <= extra) {
+					return -1;
+				}
+				c &= 0x3f >> extra;
+				for (int k = 1; k <= extra; ++ k) {
+					if ((text[i + k] & 0xc0) != 0x80) {
+						return -1;
+					}
+					c = c << 6 | (text[i + k] & 0x3f);
+				}
+				static const uint smallest[] = { 0, 0x80, 0x800, 0x10000 };
+				if (c < smallest[extra] || c > 0x10ffff
+						|| (c >= 0xd800 && c < 0xe000) || (c >= 0xfdd0 && c < 0xfdf0)
+						|| (c & 0xfffe) == 0xfffe || c == 0xfeff) {
+					return -1;
+				}
+				i += extra + 1;
+				size += c >= 0x10000 ? 2 : 1;
+			}
+			return size;
+		}
+
+		auto add(const JsonNode& node) -> bool {
+			if (open.isEmpty()) {
+				root = node;
+			} else {
+				pending.append(node);
+			}
+			return true;
+		}
+
+		auto close() -> bool {
+			Open last = open.takeLast();
+			int count = pending.size() - last.start;
+			JsonNode* children = arena->allocate<JsonNode>(count);
+			if (count > 0) {
+				std::memcpy(children, pending.constData() + last.start,
+							size_t(count) * sizeof(JsonNode));
+			}
+			pending.resize(last.start);
+			JsonNode node = scalar(last.isObject ? JsonValue::Object : JsonValue::Array);
+			node.size = last.isObject ? count / 2 : count;
+			node.children = children;
+			return add(node);
+		}
+
+		JsonArena* arena;
+		QVector<Open> open;
+		QVector<JsonNode> pending;
+		JsonNode root;
+};
+
+// an array or object in a `JsonArena` that has not been handed out yet
+class JsonArenaSpan : public JsonLazySpan {
+	public:
+		JsonArenaSpan(QExplicitlySharedDataPointer<JsonArena> arena, const JsonNode* node)
+			:	arena(arena), node(node) { }
+
+		QExplicitlySharedDataPointer<JsonArena> arena;
+		const JsonNode* node;
+
+		auto read() const -> JsonValue override;
+
+		auto source() const -> JsonLazySource* override {
+			return arena.data();
+		}
+
+		// the value of `node`; an array or object in it is handed
+		// out when it is first used
+		static auto value(const QExplicitlySharedDataPointer<JsonArena>& arena,
+						  const JsonNode* node) -> JsonValue;
+};
+
+}
+
+// private data class
+class JSON::JsonDocumentPrivate : public QSharedData {
+	public:
+		JsonDocumentPrivate()
+			:	node(nullptr), root(JsonValue::Null) { }
+
+		JsonDocumentPrivate(QExplicitlySharedDataPointer<JsonArena> arena,
+							const JsonNode* node)
+			:	arena(arena), node(node),
+				root(JsonArenaSpan::value(arena, node)) { }
+
+		// null for an empty document
+		QExplicitlySharedDataPointer<JsonArena> arena;
+		const JsonNode* node;
+		// handed out by every call to `root()`, so that
+		// its arrays and objects are only made once
+		JsonValue root;
+};
+
+#endif // JSON_DOCUMENT_P_H
@@ -0,0 +1,50 @@
+// header file
+#include <JsonDataTree/JsonHandler.h>
+
+using namespace JSON;
+
+JsonHandler::~JsonHandler() { }
+
+auto JsonHandler::startObject() -> bool {
+	return true;
+}
+
+auto JsonHandler::key(const QString&) -> bool {
+	return true;
+}
+
+auto JsonHandler::endObject() -> bool {
+	return true;
+}
+
+auto JsonHandler::startArray() -> bool {
+	return true;
+}
+
+auto JsonHandler::endArray() -> bool {
+	return true;
+}
+
+auto JsonHandler::string(const QString&) -> bool {
+	return true;
+}
+
+auto JsonHandler::number(double) -> bool {
+	return true;
+}
+
+auto JsonHandler::integer(qint64 value) -> bool {
+	return number(double(value));
+}
+
+auto JsonHandler::unsignedInteger(quint64 value) -> bool {
+	return number(double(value));
+}
+
+auto JsonHandler::boolean(bool) -> bool {
+	return true;
+}
+
+auto JsonHandler::null() -> bool {
+	return true;
+}
@@ -0,0 +1,123 @@
+#ifndef JSON_KEY_CACHE_P_H
+#define JSON_KEY_CACHE_P_H
+
+// for the data
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+
+// for sharing keys between readers
+#include <JsonDataTree/JsonKeyTable.h>
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// the keys one reader has seen so far, so that each of them is only
+// made into a `QString` once; only short keys in plain ASCII are
+// kept, which is nearly all of them. Not thread-safe.
+class JsonKeyCache {
+	public:
+		// longer keys are unlikely to come up again
+		static const int maxLength = 64;
+		// documents with more keys than this are most likely
+		// using them as data, so the rest are not kept
+		static const int maxKeys = 1 << 12;
+
+		JsonKeyCache(JsonKeyTable* table = nullptr)
+			:	used(0), table(table) { }
+
+		// the key with the given ASCII characters
+		template <class Char>
+		auto key(const Char* data, int length) -> QString {
+			if (length == 0 || length > maxLength) {
+				return text(data, length);
+			}
+			uint hash = 2166136261u;
+			for (int i = 0; i < length; ++ i) {
+				hash = (hash ^ data[i]) * 16777619u;
+			}
+			if (entries.isEmpty()) {
+				entries.resize(64);
+			}
+			int mask = entries.size() - 1;
+			for (int i = int(hash) & mask; ; i = (i + 1) & mask) {
+				Entry& entry = entries[i];
+				if (entry.key.isNull()) {
+					QString key = text(data, length);
+					if (table) {
+						key = table->intern(key);
+					}
+					if (used < maxKeys) {
+						entry.hash = hash;
+						entry.key = key;
+						if (++ used * 2 > entries.size()) {
+							grow();
+						}
+					}
+					return key;
+				}
+				if (entry.hash == hash && equals(entry.key, data, length)) {
+					return entry.key;
+				}
+			}
+		}
+
+	private:
+		class Entry {
+			public:
+				Entry()
+					:	hash(0) { }
+
+				uint hash;
+				QString key;
+		};
+
+		static auto text(const uchar* data, int length) -> QString {
+			return QString::fromLatin1(reinterpret_cast<const char*>(data), length);
+		}
+
+		static auto text(const ushort* data, int length) -> QString {
+			return QString(reinterpret_cast<const QChar*>(data), length);
+		}
+
+		template <class Char>
+		static auto equals(const QString& key, const Char* data, int length) -> bool {
+			if (key.length() != length) {
+				return false;
+			}
+			const ushort* chars = key.utf16();
+			for (int i = 0; i < length; ++ i) {
+				if (chars[i] != data[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// keep the table at most half full
+		auto grow() -> void {
+			QVector<Entry> old(entries.size() * 2);
+			old.swap(entries);
+			int mask = entries.size() - 1;
+			for (const Entry& entry : old) {
+				if (entry.key.isNull()) {
+					continue;
+				}
+				int i = int(entry.hash) & mask;
+				while (!entries.at(i).key.isNull()) {
+					i = (i + 1) & mask;
+				}
+				entries[i] = entry;
+			}
+		}
+
+		QVector<Entry> entries;
+		int used;
+		JsonKeyTable* table;
+};
+
+}
+
+#endif // JSON_KEY_CACHE_P_H
@@ -0,0 +1,41 @@
+// header file
+#include <JsonDataTree/JsonKeyTable.h>
+
+// internal data
+#include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+
+// private data class
+class JSON::JsonKeyTablePrivate {
+	public:
+		mutable QMutex mutex;
+		QSet<QString> keys;
+};
+
+using namespace JSON;
+
+JsonKeyTable::JsonKeyTable()
+	:	d(new JsonKeyTablePrivate) { }
+
+JsonKeyTable::~JsonKeyTable() { }
+
+auto JsonKeyTable::intern(const QString& key) -> QString {
+	QMutexLocker lock(&d->mutex);
+	QSet<QString>::const_iterator found = d->keys.constFind(key);
+	if (found != d->keys.constEnd()) {
+		return *found;
+	}
+	d->keys.insert(key);
+	return key;
+}
+
+auto JsonKeyTable::size() const -> int {
+	QMutexLocker lock(&d->mutex);
+	return d->keys.size();
+}
+
+auto JsonKeyTable::clear() -> void {
+	QMutexLocker lock(&d->mutex);
+	d->keys.clear();
+}
@@ -0,0 +1,180 @@
+// header file
+#include "JsonLazyValue_p.h"
+
+// for the containers
+#include <JsonDataTree/JsonArray.h>
+#include <JsonDataTree/JsonObject.h>
+#include <algorithm>
+
+using namespace JSON;
+
+// record where each array and object of the first value starts and ends
+template <class Char>
+static auto findBrackets(const Char* data, int length,
+						 QVector<int>& opens, QVector<int>& closes) -> void {
+	QVector<int> open;
+	for (int i = 0; i < length; ++ i) {
+		switch (data[i]) {
+			case '\"':
+				for (++ i; i < length && data[i] != '\"'; ++ i) {
+					if (data[i] == '\\') {
+						++ i;
+					}
+				}
+				break;
+			case '/':
+				if (i + 1 < length && data[i + 1] == '/') {
+					while (i < length && data[i] != '\n') {
+						++ i;
+					}
+				} else if (i + 1 < length && data[i + 1] == '*') {
+					for (i += 2; i + 1 < length; ++ i) {
+						if (data[i] == '*' && data[i + 1] == '/') {
+							++ i;
+							break;
+						}
+					}
+				}
+				break;
+			case '[': case '{':
+				open.append(opens.size());
+				opens.append(i);
+				closes.append(-1);
+				break;
+			case ']': case '}':
+				if (open.isEmpty()) {
+					// after a value that is not an array or object
+					return;
+				}
+				closes[open.last()] = i;
+				open.removeLast();
+				if (open.isEmpty()) {
+					// anything after the value is ignored
+					return;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+auto JsonLazyText::findBrackets() -> void {
+	if (utf8) {
+		::findBrackets(reinterpret_cast<const uchar*>(bytes.constData()),
+					   bytes.size(), opens, closes);
+	} else {
+		::findBrackets(text.utf16(), text.length(), opens, closes);
+	}
+}
+
+auto JsonLazyText::matching(int open) const -> int {
+	QVector<int>::const_iterator found
+		= std::lower_bound(opens.constBegin(), opens.constEnd(), open);
+	return closes.at(found - opens.constBegin());
+}
+
+auto JsonLazySpan::later(JsonValue::Type type, JsonLazySpan* span) -> JsonValue {
+	return JsonValue(type, span);
+}
+
+auto JsonLazyTextSpan::read() const -> JsonValue {
+	if (text->utf8) {
+		return readContainer(reinterpret_cast<const uchar*>(text->bytes.constData()),
+							 text->bytes.size());
+	}
+	return readContainer(text->text.utf16(), text->text.length());
+}
+
+auto JsonLazyTextSpan::root(QExplicitlySharedDataPointer<JsonLazyText> text) -> JsonValue {
+	text->findBrackets();
+	if (text->utf8) {
+		const uchar* data = reinterpret_cast<const uchar*>(text->bytes.constData());
+		JsonCursor<uchar> cursor(data, text->bytes.size(), nullptr);
+		cursor.pos += byteOrderMarkLength(data, text->bytes.size());
+		JsonLexer::skipNonData(cursor);
+		return readValue(text, cursor);
+	}
+	JsonCursor<ushort> cursor(text->text.utf16(), text->text.length(), nullptr);
+	JsonLexer::skipNonData(cursor);
+	return readValue(text, cursor);
+}
+
+template <class Char>
+auto JsonLazyTextSpan::readValue(const QExplicitlySharedDataPointer<JsonLazyText>& text,
+								 JsonCursor<Char>& cursor) -> JsonValue {
+	int offset = cursor.offset();
+	switch (cursor.peek()) {
+		case '{':
+		case '[': {
+			// skip to the end, and leave the inside for later
+			JsonValue::Type type = cursor.peek() == '{'
+				? JsonValue::Object : JsonValue::Array;
+			cursor.pos = cursor.begin + text->matching(offset) + 1;
+			return later(type, new JsonLazyTextSpan(text, offset));
+		}
+		case '\"': {
+			const Char* start;
+			int length;
+			if (text->views && JsonLexer::readPlainString(cursor, start, length)) {
+				return text->view(start, length);
+			}
+			return JsonLexer::readString(cursor);
+		}
+		case 't':
+			JsonLexer::readLiteral(cursor, "true");
+			return true;
+		case 'f':
+			JsonLexer::readLiteral(cursor, "false");
+			return false;
+		case 'n':
+			JsonLexer::readLiteral(cursor, "null");
+			return JsonValue::Null;
+		default: {
+			JsonNumber number = JsonLexer::readNumber(cursor);
+			switch (number.kind) {
+				case JsonNumber::Signed:
+					return number.integer;
+				case JsonNumber::Unsigned:
+					return number.natural;
+				default:
+					return number.real;
+			}
+		}
+	}
+}
+
+template <class Char>
+auto JsonLazyTextSpan::readContainer(const Char* data, int length) const -> JsonValue {
+	JsonCursor<Char> cursor(data, length, nullptr);
+	cursor.pos += begin;
+	cursor.keys = &text->keys;
+	bool isObject = cursor.peek() == '{';
+	ushort close = isObject ? '}' : ']';
+	JsonObject object;
+	JsonArray array;
+
+	// everything has been checked, so there is nothing to go wrong
+	cursor.advance();
+	JsonLexer::skipNonData(cursor);
+	while (cursor.peek() != close) {
+		if (isObject) {
+			QString key = JsonLexer::readKey(cursor);
+			JsonLexer::skipNonData(cursor);
+			cursor.advance(); // the :
+			JsonLexer::skipNonData(cursor);
+			object.insert(key, readValue(text, cursor));
+		} else {
+			array.append(readValue(text, cursor));
+		}
+		JsonLexer::skipNonData(cursor);
+		if (cursor.peek() == ',') {
+			cursor.advance();
+			JsonLexer::skipNonData(cursor);
+		}
+	}
+	if (isObject) {
+		return object;
+	}
+	return array;
+}
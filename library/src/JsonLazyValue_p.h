@@ -0,0 +1,144 @@
+#ifndef JSON_LAZY_VALUE_P_H
+#define JSON_LAZY_VALUE_P_H
+
+// for the data
+#include <JsonDataTree/JsonValue.h>
+#include <QSharedData>
+#include <QExplicitlySharedDataPointer>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+
+// for reading the values
+#include "JsonLexer_p.h"
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// what arrays and objects that have not been read yet are read
+// from; copies of a value share it, so they may be read on several
+// threads at once, and the ones from the same source are read one
+// at a time
+class JsonLazySource : public QSharedData {
+	public:
+		explicit JsonLazySource(JsonKeyTable* table = nullptr)
+			:	keys(table) { }
+
+		virtual ~JsonLazySource() { }
+
+		// held while an array or object is read from this
+		QMutex mutex;
+
+		// the keys of the objects read so far
+		JsonKeyCache keys;
+
+	private:
+		Q_DISABLE_COPY(JsonLazySource)
+};
+
+// a whole document, kept so that its arrays and objects can be
+// read when they are first used, or so that its strings can be
+// left in it until they are used
+class JsonLazyText : public JsonLazySource {
+	public:
+		JsonLazyText(QString text, JsonKeyTable* table)
+			:	JsonLazySource(table), text(text), utf8(false), views(false) { }
+
+		JsonLazyText(QByteArray bytes, JsonKeyTable* table)
+			:	JsonLazySource(table), bytes(bytes), utf8(true), views(false) { }
+
+		// only one of these is used
+		QString text;
+		QByteArray bytes;
+		bool utf8;
+
+		// whether strings without escapes are left in the text
+		bool views;
+
+		// the offset of every [ and { in the document, in order,
+		// and of the ] or } that goes with each of them
+		QVector<int> opens;
+		QVector<int> closes;
+
+		// fill in the brackets; the text must have been
+		// checked for mistakes already
+		auto findBrackets() -> void;
+
+		// where the array or object starting at `open` ends
+		auto matching(int open) const -> int;
+
+		// a string value made of the `length` characters at
+		// `start`, which is in this text, and only decoded
+		// when the value is used
+		auto view(const uchar* start, int length) -> JsonValue {
+			return JsonValue(this, int(start - reinterpret_cast<const uchar*>(bytes.constData())),
+							 length);
+		}
+
+		auto view(const ushort* start, int length) -> JsonValue {
+			return JsonValue(this, int(start - text.utf16()), length);
+		}
+
+		// decode the `length` characters at `offset`
+		auto slice(int offset, int length) const -> QString {
+			if (utf8) {
+				return QString::fromUtf8(bytes.constData() + offset, length);
+			}
+			return QString(text.constData() + offset, length);
+		}
+};
+
+// an array or object that has not been read yet
+class JsonLazySpan {
+	public:
+		virtual ~JsonLazySpan() { }
+
+		// read the array or object, leaving the arrays
+		// and objects inside of it for later
+		virtual auto read() const -> JsonValue = 0;
+
+		// what it is read from
+		virtual auto source() const -> JsonLazySource* = 0;
+
+	protected:
+		// an array or object of the given type that `span`
+		// reads when it is first used; takes ownership of `span`
+		static auto later(JsonValue::Type type, JsonLazySpan* span) -> JsonValue;
+};
+
+// an array or object in a `JsonLazyText` that has not been read yet
+class JsonLazyTextSpan : public JsonLazySpan {
+	public:
+		JsonLazyTextSpan(QExplicitlySharedDataPointer<JsonLazyText> text, int begin)
+			:	text(text), begin(begin) { }
+
+		QExplicitlySharedDataPointer<JsonLazyText> text;
+		int begin;
+
+		auto read() const -> JsonValue override;
+
+		auto source() const -> JsonLazySource* override {
+			return text.data();
+		}
+
+		// the document's value: a lazy array or object, or
+		// a scalar; the text must have been checked already
+		static auto root(QExplicitlySharedDataPointer<JsonLazyText> text) -> JsonValue;
+
+	private:
+		// read the value starting at `cursor`
+		template <class Char>
+		static auto readValue(const QExplicitlySharedDataPointer<JsonLazyText>& text,
+							  JsonCursor<Char>& cursor) -> JsonValue;
+
+		// read the array or object starting at `begin`
+		template <class Char>
+		auto readContainer(const Char* data, int length) const -> JsonValue;
+};
+
+}
+
+#endif // JSON_LAZY_VALUE_P_H
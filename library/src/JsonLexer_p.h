@@ -0,0 +1,798 @@
+#ifndef JSON_LEXER_P_H
+#define JSON_LEXER_P_H
+
+// for the data types
+#include <QtGlobal>
+#include <QString>
+#include <QByteArray>
+#include <QChar>
+#include <limits>
+
+// for errors
+#include <JsonDataTree/JsonReader.h>
+
+// for object keys
+#include "JsonKeyCache_p.h"
+
+// for numbers Clinger's fast path can't read
+#include "JsonNumberFormat_p.h"
+
+// The pieces shared by everything that reads JSON text: the cursor,
+// and the code that reads strings, numbers, literals, white space
+// and comments. Internal; not part of the public API.
+
+namespace JSON
+{
+
+// what a reader accepts besides standard JSON; the reader is built
+// once for each of these, so the checks for what one of them does
+// not accept are left out of it altogether
+
+// standard JSON only
+class JsonStrictDialect {
+	public:
+		static const bool comments = false;
+		static const bool trailingCommas = false;
+};
+
+// comments, both // and /* */, wherever white space can go
+class JsonCommentDialect {
+	public:
+		static const bool comments = true;
+		static const bool trailingCommas = false;
+};
+
+// comments, and a comma after the last value of an array or object
+class JsonRelaxedDialect {
+	public:
+		static const bool comments = true;
+		static const bool trailingCommas = true;
+};
+
+// a read position in a contiguous buffer of text, either
+// UTF-16 (ushort) or UTF-8 (uchar) code units
+template <class Char, class Dialect = JsonCommentDialect>
+class JsonCursor {
+	public:
+		JsonCursor(const Char* data, int length,
+				   JsonReaderErrors* errors)
+			:	begin(data), pos(data), end(data + length),
+				errors(errors), keys(nullptr), failed(false) { }
+
+		// the current code unit, or 0 past the end
+		auto peek() const -> ushort {
+			return pos < end ? *pos : 0;
+		}
+
+		// the code unit after the current one, or 0
+		auto peekNext() const -> ushort {
+			return pos + 1 < end ? pos[1] : 0;
+		}
+
+		auto advance() -> void {
+			++ pos;
+		}
+
+		auto atEnd() const -> bool {
+			return pos >= end;
+		}
+
+		auto offset() const -> int {
+			return pos - begin;
+		}
+
+		// record an error; parsing stops at the first one
+		auto error(JsonReaderError::ErrorType type, int at) -> void {
+			failed = true;
+			if (errors) {
+				errors->addError(type, at);
+			}
+		}
+
+		// the handler returns false to stop the parser
+		auto handled(bool more, int at) -> void {
+			if (!more) {
+				error(JsonReaderError::StoppedByHandler, at);
+			}
+		}
+
+		const Char* begin;
+		const Char* pos;
+		const Char* end;
+		JsonReaderErrors* errors;
+		// where object keys are looked up, if anywhere
+		JsonKeyCache* keys;
+		bool failed;
+};
+
+// the number of code units of the character at p if it is
+// non-ASCII white space, 0 otherwise
+static inline auto unicodeSpace(const ushort* p, const ushort*) -> int {
+	return QChar::isSpace(*p) ? 1 : 0;
+}
+
+static inline auto unicodeSpace(const uchar* p, const uchar* end) -> int {
+	// decode the UTF-8 sequence; only 2 and 3 byte
+	// sequences can hold white space
+	if ((p[0] & 0xe0) == 0xc0 && end - p >= 2) {
+		uint c = (uint(p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+		return QChar::isSpace(c) ? 2 : 0;
+	}
+	if ((p[0] & 0xf0) == 0xe0 && end - p >= 3) {
+		uint c = (uint(p[0] & 0x0f) << 12) | (uint(p[1] & 0x3f) << 6)
+			| (p[2] & 0x3f);
+		return QChar::isSpace(c) ? 3 : 0;
+	}
+	return 0;
+}
+
+// skip the white space that QTextStream::skipWhiteSpace() used to
+// skip, with the four JSON white space characters checked first
+template <class Char>
+static inline auto skipSpace(const Char*& pos, const Char* end) -> void {
+	while (pos < end) {
+		uint c = *pos;
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t'
+				|| c == '\v' || c == '\f') {
+			++ pos;
+		} else if (c < 0x80) {
+			return;
+		} else {
+			int n = unicodeSpace(pos, end);
+			if (!n) {
+				return;
+			}
+			pos += n;
+		}
+	}
+}
+
+// the length of the UTF-8 byte order mark at the start of
+// the text, if there is one
+static inline auto byteOrderMarkLength(const ushort*, int) -> int {
+	return 0;
+}
+
+static inline auto byteOrderMarkLength(const uchar* p, int n) -> int {
+	return n >= 3 && p[0] == 0xef && p[1] == 0xbb && p[2] == 0xbf ? 3 : 0;
+}
+
+// turn a run of text without escapes into a string
+static inline auto toText(const ushort* p, int n) -> QString {
+	return QString(reinterpret_cast<const QChar*>(p), n);
+}
+
+static inline auto toText(const uchar* p, int n) -> QString {
+	return QString::fromUtf8(reinterpret_cast<const char*>(p), n);
+}
+
+static inline auto appendText(QString& s, const ushort* p, int n) -> void {
+	s.append(reinterpret_cast<const QChar*>(p), n);
+}
+
+static inline auto appendText(QString& s, const uchar* p, int n) -> void {
+	s.append(toText(p, n));
+}
+
+// both of these are locale-independent
+static inline auto toDouble(const ushort* p, int n, bool* ok) -> double {
+	return QString::fromRawData(reinterpret_cast<const QChar*>(p), n)
+		.toDouble(ok);
+}
+
+static inline auto toDouble(const uchar* p, int n, bool* ok) -> double {
+	return QByteArray::fromRawData(reinterpret_cast<const char*>(p), n)
+		.toDouble(ok);
+}
+
+// the powers of ten that a double holds exactly
+static inline auto exactPowerOfTen(int n) -> double {
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	return powers[n];
+}
+
+static inline auto hexValue(ushort c) -> int {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+// a number as it was written; integers that fit in 64 bits
+// are kept exactly instead of being rounded to a double
+class JsonNumber {
+	public:
+		enum Kind {
+			Double,
+			Signed,
+			Unsigned    // only for those too big to be Signed
+		};
+
+		JsonNumber()
+			:	kind(Double), real(0.0) { }
+
+		auto toDouble() const -> double {
+			switch (kind) {
+				case Signed:
+					return double(integer);
+				case Unsigned:
+					return double(natural);
+				default:
+					return real;
+			}
+		}
+
+		// the number as an integer type, as JsonNumber::clamp()
+		// makes a double one
+		template <class Integer>
+		auto toInteger(bool& exact) const -> Integer {
+			switch (kind) {
+				case Signed:
+					exact = integer >= 0 || std::numeric_limits<Integer>::is_signed;
+					return exact ? Integer(integer) : 0;
+				case Unsigned:
+					exact = !std::numeric_limits<Integer>::is_signed;
+					return exact ? Integer(natural) : std::numeric_limits<Integer>::max();
+				default:
+					return clamp<Integer>(real, exact);
+			}
+		}
+
+		// `number` rounded toward zero and held to the range of an
+		// integer type, with NaN as 0; `exact` is set to whether the
+		// type holds it exactly
+		template <class Integer>
+		static auto clamp(double number, bool& exact) -> Integer {
+			// the lowest value is exact as a double, and the highest
+			// rounds up to the power of two just past it
+			const double lowest = double(std::numeric_limits<Integer>::min());
+			const double pastHighest = double(std::numeric_limits<Integer>::max());
+			exact = false;
+			if (number != number) {
+				return 0;
+			}
+			if (number < lowest) {
+				return std::numeric_limits<Integer>::min();
+			}
+			if (number >= pastHighest) {
+				return std::numeric_limits<Integer>::max();
+			}
+			Integer ans = Integer(number);
+			exact = double(ans) == number;
+			return ans;
+		}
+
+		// hand the number to whichever function of the handler fits
+		template <class Handler>
+		auto handle(Handler& handler) const -> bool {
+			switch (kind) {
+				case Signed:
+					return handler.integer(integer);
+				case Unsigned:
+					return handler.unsignedInteger(natural);
+				default:
+					return handler.number(real);
+			}
+		}
+
+		Kind kind;
+		union {
+			double real;
+			qint64 integer;
+			quint64 natural;
+		};
+};
+
+// reads single tokens from a cursor; errors go to the cursor
+class JsonLexer {
+	public:
+		// read a string from the cursor
+		template <class Char, class Dialect>
+		static auto readString(JsonCursor<Char, Dialect>& cursor) -> QString;
+
+		// find the characters of a string without escapes and move
+		// past it; if it has any, leave the cursor where it is
+		template <class Char, class Dialect>
+		static auto readPlainString(JsonCursor<Char, Dialect>& cursor,
+									const Char*& start, int& length) -> bool;
+
+		// read an object key from the cursor, through
+		// the cursor's key cache if it has one
+		template <class Char, class Dialect>
+		static auto readKey(JsonCursor<Char, Dialect>& cursor) -> QString;
+
+		// read a number from the cursor
+		template <class Char, class Dialect>
+		static auto readNumber(JsonCursor<Char, Dialect>& cursor) -> JsonNumber;
+
+		// read a literal (true, false, null) from the cursor
+		template <class Char, class Dialect>
+		static auto readLiteral(JsonCursor<Char, Dialect>& cursor, const char* literal) -> bool;
+
+		// skip over comments and white space
+		template <class Char, class Dialect>
+		static auto skipNonData(JsonCursor<Char, Dialect>& cursor) -> void;
+
+		// check a string from the cursor the same way readString()
+		// reads it, without decoding it into anything
+		template <class Char, class Dialect>
+		static auto checkString(JsonCursor<Char, Dialect>& cursor) -> void;
+
+		// skip over a string, only looking for the closing quote
+		template <class Char, class Dialect>
+		static auto skipString(JsonCursor<Char, Dialect>& cursor) -> void;
+
+		// skip over a whole value, only matching up the brackets
+		// and quotes; what is between them is not checked
+		template <class Char, class Dialect>
+		static auto skipValue(JsonCursor<Char, Dialect>& cursor) -> void;
+};
+
+template <class Char, class Dialect>
+auto JsonLexer::readLiteral(JsonCursor<Char, Dialect>& cursor,
+									const char* literal) -> bool {
+	const Char* p = cursor.pos;
+	for (; *literal; ++ literal, ++ p) {
+		if (p >= cursor.end || *p != Char(*literal)) {
+			return false;
+		}
+	}
+	cursor.pos = p;
+	return true;
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::readString(JsonCursor<Char, Dialect>& cursor) -> QString {
+	int offset = cursor.offset();
+	// get rid of the first quote
+	cursor.advance();
+	// find the first run of plain characters; most strings
+	// have no escapes, so this is usually the whole thing
+	const Char* run = cursor.pos;
+	while (cursor.pos < cursor.end
+			&& *cursor.pos != '\"' && *cursor.pos != '\\') {
+		++ cursor.pos;
+	}
+	if (cursor.pos < cursor.end && *cursor.pos == '\"') {
+		QString ans = toText(run, cursor.pos - run);
+		cursor.advance();
+		return ans;
+	}
+	// there are escapes, so build it up piece by piece
+	QString ans;
+	ans.reserve(cursor.pos - run + 16);
+	while (cursor.pos < cursor.end) {
+		ushort c = *cursor.pos;
+		if (c == '\"') {
+			appendText(ans, run, cursor.pos - run);
+			cursor.advance();
+			return ans;
+		}
+		if (c != '\\') {
+			++ cursor.pos;
+			continue;
+		}
+		// flush the plain characters before the escape
+		appendText(ans, run, cursor.pos - run);
+		int escapeOffset = cursor.offset();
+		cursor.advance();
+		switch (cursor.peek()) {
+			case '\"': // double quote
+				ans.append(QChar('\"'));
+				break;
+			case '\\': // backslash
+				ans.append(QChar('\\'));
+				break;
+			case '/': // forward slash
+				ans.append(QChar('/'));
+				break;
+			case 'b': // backspace
+				ans.append(QChar('\b'));
+				break;
+			case 'f': // formfeed
+				ans.append(QChar('\f'));
+				break;
+			case 'n': // newline
+				ans.append(QChar('\n'));
+				break;
+			case 'r': // linefeed
+				ans.append(QChar('\r'));
+				break;
+			case 't': // tab
+				ans.append(QChar('\t'));
+				break;
+			case 'u': { // 4-letter unicode hex
+				cursor.advance();
+				int hexOffset = cursor.offset();
+				int number = 0;
+				for (int i = 0; i < 4; ++ i) {
+					int digit = hexValue(cursor.peek());
+					if (digit < 0) {
+						cursor.error(JsonReaderError::StringWithBadHex,
+									 hexOffset);
+						return ans;
+					}
+					number = (number << 4) | digit;
+					cursor.advance();
+				}
+				// output the corresponding char
+				ans.append(QChar(ushort(number)));
+				run = cursor.pos;
+				continue;
+			}
+			case 0:
+				if (cursor.atEnd()) {
+					// ran out in the middle of the escape
+					cursor.error(JsonReaderError::StringWithNoClosingQuote,
+								 offset);
+					return ans;
+				}
+				// fall through
+			default:
+				cursor.error(JsonReaderError::StringWithBadEscape,
+							 escapeOffset);
+				return ans;
+		} // end escape switch statement
+		cursor.advance();
+		run = cursor.pos;
+	}
+
+	// we didn't reach the end of the string
+	cursor.error(JsonReaderError::StringWithNoClosingQuote, offset);
+	return ans;
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::checkString(JsonCursor<Char, Dialect>& cursor) -> void {
+	int offset = cursor.offset();
+	// get rid of the first quote
+	cursor.advance();
+	while (cursor.pos < cursor.end) {
+		ushort c = *cursor.pos;
+		if (c == '\"') {
+			cursor.advance();
+			return;
+		}
+		if (c != '\\') {
+			++ cursor.pos;
+			continue;
+		}
+		int escapeOffset = cursor.offset();
+		cursor.advance();
+		switch (cursor.peek()) {
+			case '\"': case '\\': case '/':
+			case 'b': case 'f': case 'n':
+			case 'r': case 't':
+				cursor.advance();
+				break;
+			case 'u': { // 4-letter unicode hex
+				cursor.advance();
+				int hexOffset = cursor.offset();
+				for (int i = 0; i < 4; ++ i) {
+					if (hexValue(cursor.peek()) < 0) {
+						cursor.error(JsonReaderError::StringWithBadHex,
+									 hexOffset);
+						return;
+					}
+					cursor.advance();
+				}
+				break;
+			}
+			case 0:
+				if (cursor.atEnd()) {
+					// ran out in the middle of the escape
+					cursor.error(JsonReaderError::StringWithNoClosingQuote,
+								 offset);
+					return;
+				}
+				// fall through
+			default:
+				cursor.error(JsonReaderError::StringWithBadEscape,
+							 escapeOffset);
+				return;
+		}
+	}
+
+	// we didn't reach the end of the string
+	cursor.error(JsonReaderError::StringWithNoClosingQuote, offset);
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::readPlainString(JsonCursor<Char, Dialect>& cursor,
+								const Char*& start, int& length) -> bool {
+	const Char* run = cursor.pos + 1;
+	const Char* p = run;
+	while (p < cursor.end && *p != '\"' && *p != '\\') {
+		++ p;
+	}
+	if (p < cursor.end && *p == '\"') {
+		start = run;
+		length = int(p - run);
+		cursor.pos = p + 1;
+		return true;
+	}
+	return false;
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::readKey(JsonCursor<Char, Dialect>& cursor) -> QString {
+	if (!cursor.keys) {
+		return readString(cursor);
+	}
+	// the same as the start of readString(), but
+	// also checking for anything that is not ASCII
+	const Char* run = cursor.pos + 1;
+	const Char* p = run;
+	ushort bits = 0;
+	while (p < cursor.end && *p != '\"' && *p != '\\') {
+		bits |= *p;
+		++ p;
+	}
+	if (p < cursor.end && *p == '\"') {
+		cursor.pos = p + 1;
+		if (bits < 0x80) {
+			return cursor.keys->key(run, int(p - run));
+		}
+		return toText(run, int(p - run));
+	}
+	// escapes are decoded the usual way
+	return readString(cursor);
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::readNumber(JsonCursor<Char, Dialect>& cursor) -> JsonNumber {
+	int offset = cursor.offset();
+	const Char* start = cursor.pos;
+	bool good = true;
+
+	// the value is mantissa * 10^exponent, with digits past the
+	// 20th or so dropped from the mantissa
+	quint64 mantissa = 0;
+	int exponent = 0;
+	bool dropped = false;
+	bool integral = true;
+
+	// -?digits(.digits)?([eE][+-]?digits)?
+	bool negative = cursor.peek() == '-';
+	if (negative) {
+		cursor.advance();
+	}
+	const Char* digits = cursor.pos;
+	while (cursor.peek() >= '0' && cursor.peek() <= '9') {
+		uint digit = cursor.peek() - '0';
+		if (mantissa < 1844674407370955161ULL
+				|| (mantissa == 1844674407370955161ULL && digit <= 5)) {
+			mantissa = mantissa * 10 + digit;
+		} else {
+			dropped = true;
+			++ exponent;
+		}
+		cursor.advance();
+	}
+	good = cursor.pos != digits;
+	if (good && cursor.peek() == '.') {
+		integral = false;
+		cursor.advance();
+		digits = cursor.pos;
+		while (cursor.peek() >= '0' && cursor.peek() <= '9') {
+			uint digit = cursor.peek() - '0';
+			if (mantissa < 1844674407370955161ULL) {
+				mantissa = mantissa * 10 + digit;
+				-- exponent;
+			} else {
+				dropped = true;
+			}
+			cursor.advance();
+		}
+		good = cursor.pos != digits;
+	}
+	if (good && (cursor.peek() == 'e' || cursor.peek() == 'E')) {
+		integral = false;
+		cursor.advance();
+		bool negativeExponent = cursor.peek() == '-';
+		if (cursor.peek() == '+' || cursor.peek() == '-') {
+			cursor.advance();
+		}
+		digits = cursor.pos;
+		int written = 0;
+		while (cursor.peek() >= '0' && cursor.peek() <= '9') {
+			// far past where a double overflows or underflows
+			if (written < 100000) {
+				written = written * 10 + (cursor.peek() - '0');
+			}
+			cursor.advance();
+		}
+		good = cursor.pos != digits;
+		exponent += negativeExponent ? -written : written;
+	}
+	if (!good) {
+		cursor.error(JsonReaderError::NumberWithBadCharacter, offset);
+		return JsonNumber();
+	}
+
+	JsonNumber ans;
+	if (integral && !dropped) {
+		if (!negative && mantissa <= quint64(Q_INT64_C(0x7fffffffffffffff))) {
+			ans.kind = JsonNumber::Signed;
+			ans.integer = qint64(mantissa);
+			return ans;
+		}
+		if (!negative) {
+			ans.kind = JsonNumber::Unsigned;
+			ans.natural = mantissa;
+			return ans;
+		}
+		// -0 stays a double, so that the sign is kept
+		if (mantissa != 0 && mantissa <= quint64(1) << 63) {
+			ans.kind = JsonNumber::Signed;
+			ans.integer = -qint64(mantissa - 1) - 1;
+			return ans;
+		}
+	}
+
+	// when both the mantissa and the power of ten are exact
+	// doubles, one multiplication or division rounds correctly
+	if (!dropped && mantissa <= quint64(1) << 53
+			&& exponent >= -22 && exponent <= 22) {
+		double value = double(mantissa);
+		if (exponent < 0) {
+			value /= exactPowerOfTen(-exponent);
+		} else {
+			value *= exactPowerOfTen(exponent);
+		}
+		ans.real = negative ? -value : value;
+		return ans;
+	}
+
+	// nearly everything else, all 17 digits of a double written
+	// out in full included, is worked out from the same digits
+	double value;
+	if (JsonNumberFormat::toDouble(mantissa, exponent, dropped, value)) {
+		ans.real = negative ? -value : value;
+		return ans;
+	}
+
+	// what is left, numbers that overflow or underflow, and those
+	// with more than 19 digits that are too close to call, is rare
+	// enough to leave to Qt
+	ans.real = toDouble(start, cursor.pos - start, &good);
+	if (!good) {
+		cursor.error(JsonReaderError::NumberWithBadCharacter, offset);
+	}
+	return ans;
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::skipNonData(JsonCursor<Char, Dialect>& cursor) -> void {
+	if (!Dialect::comments) {
+		skipSpace(cursor.pos, cursor.end);
+		return;
+	}
+	while (true) {
+		// skip preceding whitespace
+		skipSpace(cursor.pos, cursor.end);
+		if (cursor.peek() != '/') {
+			return;
+		}
+		// get the comment type
+		int commentStart = cursor.offset();
+		ushort type = cursor.peekNext();
+		if (type == '/') {
+			// single line comment
+			// skip over the line
+			while (cursor.pos < cursor.end && *cursor.pos != '\n') {
+				++ cursor.pos;
+			}
+		} else if (type == '*') {
+			/* block comment */
+			// go until after the trailing */
+			cursor.pos += 2;
+			bool quitWell = false;
+			while (cursor.pos + 1 < cursor.end) {
+				if (cursor.pos[0] == '*' && cursor.pos[1] == '/') {
+					cursor.pos += 2;
+					quitWell = true;
+					break;
+				}
+				++ cursor.pos;
+			}
+			if (!quitWell) {
+				cursor.pos = cursor.end;
+				cursor.error(JsonReaderError::CommentWithNoEnd,
+							 commentStart);
+				return;
+			}
+		} else {
+			// not a comment; let the caller deal with it
+			return;
+		}
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::skipString(JsonCursor<Char, Dialect>& cursor) -> void {
+	int offset = cursor.offset();
+	// get rid of the first quote
+	cursor.advance();
+	while (cursor.pos < cursor.end) {
+		ushort c = *cursor.pos;
+		if (c == '\"') {
+			cursor.advance();
+			return;
+		}
+		// an escaped quote does not end the string
+		cursor.pos += c == '\\' ? 2 : 1;
+	}
+	cursor.pos = cursor.end;
+	cursor.error(JsonReaderError::StringWithNoClosingQuote, offset);
+}
+
+template <class Char, class Dialect>
+auto JsonLexer::skipValue(JsonCursor<Char, Dialect>& cursor) -> void {
+	int offset = cursor.offset();
+	ushort first = cursor.peek();
+	if (first == '\"') {
+		skipString(cursor);
+		return;
+	}
+	if (first != '[' && first != '{') {
+		// a number or literal runs until the next separator
+		while (cursor.pos < cursor.end) {
+			ushort c = *cursor.pos;
+			if (c == ',' || c == ']' || c == '}' || c == ':' || c == '/'
+					|| c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+				break;
+			}
+			++ cursor.pos;
+		}
+		if (cursor.offset() == offset) {
+			// the offset is one past the start, as it always has been
+			cursor.error(JsonReaderError::UnknownLiteral, offset + 1);
+		}
+		return;
+	}
+	int depth = 0;
+	while (cursor.pos < cursor.end) {
+		switch (*cursor.pos) {
+			case '[': case '{':
+				++ depth;
+				cursor.advance();
+				break;
+			case ']': case '}':
+				cursor.advance();
+				if (-- depth == 0) {
+					return;
+				}
+				break;
+			case '\"':
+				// the brackets in strings don't count
+				skipString(cursor);
+				if (cursor.failed) return;
+				break;
+			case '/': {
+				const Char* before = cursor.pos;
+				skipNonData(cursor);
+				if (cursor.failed) return;
+				if (cursor.pos == before) {
+					// not a comment
+					cursor.advance();
+				}
+				break;
+			}
+			default:
+				cursor.advance();
+				break;
+		}
+	}
+	cursor.error(first == '{'
+					? JsonReaderError::ObjectWithNoClosingBrace
+					: JsonReaderError::ArrayWithNoClosingBracket,
+				 offset);
+}
+
+}
+
+#endif // JSON_LEXER_P_H
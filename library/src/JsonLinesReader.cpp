@@ -0,0 +1,267 @@
+// header file
+#include <JsonDataTree/JsonLinesReader.h>
+
+// internal data
+#include <QSharedData>
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QQueue>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <algorithm>
+#include <cstring>
+
+// the parser for each line
+#include "JsonReader_p.h"
+
+// private data class
+class JSON::JsonLinesReaderPrivate : public QSharedData {
+	public:
+		// some whole lines of the input, and what they held
+		class Chunk {
+			public:
+				Chunk(QByteArray data, qint64 firstLine)
+					:	data(data), firstLine(firstLine), failed(false) { }
+
+				QByteArray data;
+				qint64 firstLine;
+
+				// filled in when the callback is to be called in order
+				QList<qint64> lines;
+				JsonArray values;
+				QList<JsonReaderErrors> errors;
+
+				bool failed;
+
+				// released once the chunk has been parsed
+				QSemaphore done;
+		};
+
+		// parses one chunk on a thread in the pool
+		class Task : public QRunnable {
+			public:
+				Task(const JsonReaderPrivate& reader,
+					 QSharedPointer<Chunk> chunk, const JsonLinesReader::Callback* callback)
+					:	reader(reader), chunk(chunk), callback(callback) { }
+
+				auto run() -> void override;
+
+			private:
+				const JsonReaderPrivate& reader;
+				QSharedPointer<Chunk> chunk;
+
+				// `nullptr` to keep the values for later
+				const JsonLinesReader::Callback* callback;
+		};
+
+		JsonLinesReaderPrivate()
+			:	pool(nullptr), chunkSize(1 << 20) { }
+
+		JsonReaderPrivate reader;
+		QThreadPool* pool;
+		int chunkSize;
+
+		// read the device a chunk at a time
+		auto read(QIODevice* io, const JsonLinesReader::Callback& callback, bool ordered) const -> bool;
+
+		// the whole lines at the front of the device,
+		// with `rest` holding the start of the next line
+		auto nextChunk(QIODevice* io, QByteArray& rest) const -> QByteArray;
+
+		// check that a line has something on it
+		static auto isBlank(const char* begin, const char* end) -> bool;
+};
+
+using namespace JSON;
+
+JsonLinesReader::JsonLinesReader()
+	:	d(new JsonLinesReaderPrivate) { }
+
+JsonLinesReader::JsonLinesReader(const JsonLinesReader& other)
+	:	d(other.d) { }
+
+JsonLinesReader::~JsonLinesReader() { }
+
+auto JsonLinesReader::operator= (const JsonLinesReader& other) -> JsonLinesReader& {
+	if (this == &other) return *this;
+	d = other.d;
+	return *this;
+}
+
+auto JsonLinesReader::getEngine() const -> JsonReader::Engine {
+	return d->reader.engine;
+}
+
+auto JsonLinesReader::setEngine(JsonReader::Engine engine) -> void {
+	d->reader.engine = engine;
+}
+
+auto JsonLinesReader::getDialect() const -> JsonReader::Dialect {
+	return d->reader.dialect;
+}
+
+auto JsonLinesReader::setDialect(JsonReader::Dialect dialect) -> void {
+	d->reader.dialect = dialect;
+}
+
+auto JsonLinesReader::getThreadPool() const -> QThreadPool* {
+	return d->pool ? d->pool : QThreadPool::globalInstance();
+}
+
+auto JsonLinesReader::setThreadPool(QThreadPool* pool) -> void {
+	d->pool = pool;
+}
+
+auto JsonLinesReader::getChunkSize() const -> int {
+	return d->chunkSize;
+}
+
+auto JsonLinesReader::setChunkSize(int bytes) -> void {
+	d->chunkSize = qMax(1, bytes);
+}
+
+auto JsonLinesReader::getKeyTable() const -> JsonKeyTable* {
+	return d->reader.keyTable;
+}
+
+auto JsonLinesReader::setKeyTable(JsonKeyTable* table) -> void {
+	d->reader.keyTable = table;
+}
+
+auto JsonLinesReader::read(QIODevice* io, QList<JsonReaderErrors>* errors) const -> JsonArray {
+	JsonArray values;
+	d->read(io, [&](qint64, JsonValue value, JsonReaderErrors lineErrors) {
+		values.append(value);
+		if (errors) {
+			errors->append(lineErrors);
+		}
+	}, true);
+	return values;
+}
+
+auto JsonLinesReader::read(QIODevice* io, Callback callback, bool ordered) const -> bool {
+	return d->read(io, callback, ordered);
+}
+
+auto JsonLinesReaderPrivate::read(QIODevice* io, const JsonLinesReader::Callback& callback,
+								  bool ordered) const -> bool {
+	// a compressed log is inflated a chunk at a time alongside
+	// the parsing, and never held in full either way
+	if (JsonInflateDevice::isCompressed(io)) {
+		JsonInflateDevice inflated(io);
+		bool ans = read(&inflated, callback, ordered);
+		return !inflated.failed() && ans;
+	}
+
+	QThreadPool* threads = pool ? pool : QThreadPool::globalInstance();
+
+	// enough chunks to keep every thread busy while the next
+	// ones are read in, without holding the whole input
+	int inFlight = 2 * qMax(1, threads->maxThreadCount());
+
+	QQueue<QSharedPointer<Chunk>> queue;
+	QByteArray rest;
+	qint64 line = 0;
+	bool first = true;
+	bool ok = true;
+
+	while (true) {
+		while (queue.size() < inFlight) {
+			QByteArray data = nextChunk(io, rest);
+			if (data.isEmpty()) {
+				break;
+			}
+			// a byte order mark is not part of the first line
+			if (first && data.startsWith("\xef\xbb\xbf")) {
+				data.remove(0, 3);
+			}
+			first = false;
+
+			QSharedPointer<Chunk> chunk(new Chunk(data, line));
+			line += std::count(data.constBegin(), data.constEnd(), '\n');
+			threads->start(new Task(reader, chunk, ordered ? nullptr : &callback));
+			queue.enqueue(chunk);
+		}
+		if (queue.isEmpty()) {
+			break;
+		}
+
+		QSharedPointer<Chunk> chunk = queue.dequeue();
+		chunk->done.acquire();
+		if (chunk->failed) {
+			ok = false;
+		}
+		if (ordered) {
+			for (int i = 0; i < chunk->values.size(); ++ i) {
+				callback(chunk->lines.at(i), chunk->values.at(i),
+						 chunk->errors.at(i));
+			}
+		}
+	}
+	return ok;
+}
+
+auto JsonLinesReaderPrivate::nextChunk(QIODevice* io, QByteArray& rest) const -> QByteArray {
+	QByteArray chunk;
+	chunk.swap(rest);
+	while (true) {
+		QByteArray more = io->read(chunkSize);
+		if (more.isEmpty()) {
+			// the last line does not need a newline
+			return chunk;
+		}
+		int end = more.lastIndexOf('\n');
+		if (end < 0) {
+			// a line longer than a chunk
+			chunk += more;
+			continue;
+		}
+		chunk += more.left(end + 1);
+		rest = more.mid(end + 1);
+		return chunk;
+	}
+}
+
+auto JsonLinesReaderPrivate::isBlank(const char* begin, const char* end) -> bool {
+	for (const char* c = begin; c < end; ++ c) {
+		if (*c != ' ' && *c != '\t' && *c != '\r') {
+			return false;
+		}
+	}
+	return true;
+}
+
+auto JsonLinesReaderPrivate::Task::run() -> void {
+	const char* pos = chunk->data.constData();
+	const char* end = pos + chunk->data.size();
+	qint64 line = chunk->firstLine;
+	// the lines of a log mostly have the same keys,
+	// and are parsed with the same buffers
+	JsonReaderPrivate::Scratch scratch(reader.keyTable);
+
+	while (pos < end) {
+		const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+		if (!newline) {
+			newline = end;
+		}
+		if (!isBlank(pos, newline)) {
+			JsonReaderErrors errors;
+			JsonValue value = reader.parseUtf8(reinterpret_cast<const uchar*>(pos),
+											   int(newline - pos), &errors, &scratch);
+			if (errors.numErrors() > 0) {
+				chunk->failed = true;
+			}
+			if (callback) {
+				(*callback)(line, value, errors);
+			} else {
+				chunk->lines.append(line);
+				chunk->values.append(value);
+				chunk->errors.append(errors);
+			}
+		}
+		++ line;
+		pos = newline + 1;
+	}
+	chunk->done.release();
+}
@@ -0,0 +1,44 @@
+#ifndef JSON_NUMBER_FORMAT_P_H
+#define JSON_NUMBER_FORMAT_P_H
+
+// for the data types
+#include <QtGlobal>
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// writes numbers out as text, the same way whatever the locale,
+// into a buffer the caller provides, and works out the doubles
+// that the text of others stands for
+class JsonNumberFormat {
+	public:
+		// the most either function writes
+		static const int maxLength = 32;
+
+		// write an integer, digit for digit
+		static auto formatInteger(qint64 number, char* text) -> int;
+		static auto formatInteger(quint64 number, char* text) -> int;
+
+		// write text that reads back as exactly `number`, with
+		// Grisu2: the shortest such text for all but about 0.1%
+		// of numbers, which get a digit or two more. A number that
+		// is a whole one of up to 2^53 is written as an integer,
+		// and infinities and NaN, which JSON has no way to write,
+		// as null
+		static auto formatDouble(double number, char* text) -> int;
+
+		// the double nearest to digits * 10^exponent, with
+		// Eisel-Lemire; `truncated` means digits past these were
+		// cut off, so the number is somewhere below digits + 1.
+		// This is false, leaving `number` alone, for numbers that
+		// overflow or underflow, and for truncated ones whose
+		// digits are too close to call
+		static auto toDouble(quint64 digits, int exponent, bool truncated,
+							 double& number) -> bool;
+};
+
+}
+
+#endif // JSON_NUMBER_FORMAT_P_H
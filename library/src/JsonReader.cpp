@@ -2,502 +2,1676 @@
 #include <JsonDataTree/JsonReader.h>
 
 // internal data
-#include <QSharedData>
+#include "JsonReader_p.h"
 #include <QVariant>
+#include <QFileDevice>
+#include <QFile>
+#include <QBuffer>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QFutureInterface>
+#include <QScopedArrayPointer>
+#include <QSemaphore>
+#include <climits>
 #include <JsonDataTree/JsonObject.h>
 #include <JsonDataTree/JsonArray.h>
 
-#include <iostream>
+// first stage of the structural index engine
+#include "JsonStructuralIndex_p.h"
 
-// private data class
-class JSON::JsonReaderPrivate : public QSharedData {
-	public:
-		// read a value from the stream
-        auto readValue(QTextStream& stream, JsonReaderErrors* errors) const
-            -> JsonValue;
+using namespace JSON;
 
-		// read a string from the stream
-        auto readString(QTextStream& stream, JsonReaderErrors* errors) const
-            -> QString;
+JsonReader::JsonReader()
+	:	d(new JsonReaderPrivate) { }
 
-		// read a number from the stream
-        auto readNumber(QTextStream& stream, JsonReaderErrors* errors) const
-            -> double;
+JsonReader::~JsonReader() { }
 
-		// read an array from the stream
-        auto readArray(QTextStream& stream, JsonReaderErrors* errors) const
-            -> JsonArray;
+JsonReader::JsonReader(const JsonReader& other)
+	:	d(other.d) { }
 
-		// read an object from the stream
-        auto readObject(QTextStream& stream, JsonReaderErrors* errors) const
-            -> JsonObject;
+auto JsonReader::getEngine() const -> Engine {
+	return d->engine;
+}
 
-		// skip over comments and white space
-        auto skipNonData(QTextStream& stream, JsonReaderErrors* errors) const
-            -> void;
+auto JsonReader::setEngine(Engine engine) -> void {
+	d->engine = engine;
+}
 
-		// TODO read comments?
-};
+auto JsonReader::getDialect() const -> Dialect {
+	return d->dialect;
+}
 
-using namespace JSON;
+auto JsonReader::setDialect(Dialect dialect) -> void {
+	d->dialect = dialect;
+}
 
-JsonReader::JsonReader()
-	:	d(new JsonReaderPrivate) { }
+auto JsonReader::getMaxDepth() const -> int {
+	return qMax(0, d->maxDepth);
+}
 
-JsonReader::~JsonReader() { }
+auto JsonReader::setMaxDepth(int depth) -> void {
+	d->maxDepth = depth;
+}
 
-JsonReader::JsonReader(const JsonReader& other)
-	:	d(other.d) { }
+auto JsonReader::getThreadPool() const -> QThreadPool* {
+	return d->pool;
+}
+
+auto JsonReader::setThreadPool(QThreadPool* pool) -> void {
+	d->pool = pool;
+}
+
+auto JsonReader::getKeyTable() const -> JsonKeyTable* {
+	return d->keyTable;
+}
+
+auto JsonReader::setKeyTable(JsonKeyTable* table) -> void {
+	d->keyTable = table;
+}
+
+auto JsonReader::isLazy() const -> bool {
+	return d->lazy;
+}
+
+auto JsonReader::setLazy(bool lazy) -> void {
+	d->lazy = lazy;
+}
+
+auto JsonReader::isZeroCopy() const -> bool {
+	return d->zeroCopy;
+}
+
+auto JsonReader::setZeroCopy(bool zeroCopy) -> void {
+	d->zeroCopy = zeroCopy;
+}
 
 auto JsonReader::parse(QString string, JsonReaderErrors* errors) const -> JsonValue {
-	QTextStream stream(&string);
-	return read(stream, errors);
+	if (d->lazy || d->zeroCopy) {
+		return d->parseKept(QExplicitlySharedDataPointer<JsonLazyText>(
+								new JsonLazyText(string, d->keyTable)), errors);
+	}
+	JsonReaderPrivate::TreeBuilder builder;
+	d->parse(string.utf16(), string.length(), builder, errors);
+	return builder.result();
 }
 
 auto JsonReader::read(QIODevice* io, JsonReaderErrors* errors) const -> JsonValue {
-	QTextStream stream(io);
-	return read(stream, errors);
+	return d->readTree(io, errors);
 }
 
 auto JsonReader::read(QTextStream& stream, JsonReaderErrors* errors) const -> JsonValue {
-	// skip preceding white space and comments
-	d->skipNonData(stream, errors);
-	if (errors && errors->numErrors()) {
-		return JsonValue::Null;
-	}
-	stream.setIntegerBase(10);
-	// read in the value
-	JsonValue ans = d->readValue(stream, errors);
-	// set *ok if required
-	return ans;
+	// decode everything up front and parse from memory
+	return parse(stream.readAll(), errors);
 }
 
-auto JsonReaderPrivate::readValue(QTextStream& stream,
-								  JsonReaderErrors* errors) const -> JsonValue {
-	// get the first character
-	QChar firstChar;
-	stream >> firstChar;
-	ushort c = firstChar.unicode();
-	int offset = stream.pos();
-	// but move back, because it could be important
-	if (!stream.seek(stream.pos() - 1)) {
-		if (errors) {
-			errors->addError(JsonReaderError::StreamFailure,
-								offset);
+class JSON::JsonReaderPrivate::ReadTask : public QRunnable, public JsonReadWatch {
+	public:
+		// a file to read
+		ReadTask(const JsonReaderPrivate& reader, const QString& path,
+				 JsonReaderErrors* errors)
+			:	reader(reader), isFile(true), path(path),
+				errors(errors), length(-1) { }
+
+		// text to parse
+		ReadTask(const JsonReaderPrivate& reader, const QByteArray& data,
+				 JsonReaderErrors* errors)
+			:	reader(reader), isFile(false), data(data),
+				errors(errors), length(-1) { }
+
+		// run the task on `pool`, for the future handed back
+		auto start(QThreadPool* pool) -> QFuture<JsonValue> {
+			future.reportStarted();
+			QFuture<JsonValue> ans = future.future();
+			pool->start(this);
+			return ans;
 		}
-		return JsonValue::Null;
-	}
-	// determine what to do based on that char
-	JsonValue ans;
-	switch (c) {
-		case '{': // object
-			ans = readObject(stream, errors);
-			break;
-		case '[': // array
-			ans = readArray(stream, errors);
-			break;
-		case '\"': // string
-			ans = readString(stream, errors);
-			break;
-		case '0': case '1': case '2':
-		case '3': case '4': case '5':
-		case '6': case '7': case '8':
-		case '9': case '-': // numbers
-			ans = readNumber(stream, errors);
-			break;
-		case 'f': // false
-			if (stream.read(5) == "false") {
-				ans = false;
-			} else if (errors) {
-				errors->addError(JsonReaderError::UnknownLiteral,
-									offset);
+
+		auto run() -> void override {
+			JsonValue value = JsonValue::Null;
+			JsonReaderErrors found;
+			if (!future.isCanceled()) {
+				if (isFile) {
+					value = reader.readFile(path, &found, this);
+				} else {
+					QBuffer buffer(&data);
+					buffer.open(QIODevice::ReadOnly);
+					value = reader.readTree(&buffer, &found, this);
+				}
+				if (length > 0 && !future.isCanceled()) {
+					future.setProgressValue(length);
+				}
 			}
-			break;
-		case 't': // true
-			if (stream.read(4) == "true") {
-				ans = true;
-			} else if (errors) {
-				errors->addError(JsonReaderError::UnknownLiteral,
-									offset);
+			if (errors) {
+				*errors = found;
 			}
-			break;
-		case 'n': // null
-			if (stream.read(4) == "null") {
-				ans = JsonValue::Null;
-			} else if (errors) {
-				errors->addError(JsonReaderError::UnknownLiteral,
-									offset);
+			// there is always a result, even when canceled
+			future.reportResult(value);
+			future.reportFinished();
+		}
+
+		auto reached(int offset, int length) -> bool override {
+			if (length != this->length) {
+				this->length = length;
+				future.setProgressRange(0, length);
 			}
-			break;
-		default: // unrecognizable
-			if (errors) {
-				errors->addError(JsonReaderError::UnknownLiteral,
-									offset);
+			future.setProgressValue(offset);
+			return !future.isCanceled();
+		}
+
+	private:
+		// a copy, so the reader can change in the meantime
+		const JsonReaderPrivate reader;
+		bool isFile;
+		QString path;
+		QByteArray data;
+		JsonReaderErrors* errors;
+		// of the text being parsed
+		int length;
+		QFutureInterface<JsonValue> future;
+};
+
+auto JsonReader::readAsync(QString path, JsonReaderErrors* errors) const -> QFuture<JsonValue> {
+	JsonReaderPrivate::ReadTask* task = new JsonReaderPrivate::ReadTask(*d, path, errors);
+	return task->start(d->pool ? d->pool : QThreadPool::globalInstance());
+}
+
+auto JsonReader::parseAsync(QByteArray data, JsonReaderErrors* errors) const -> QFuture<JsonValue> {
+	JsonReaderPrivate::ReadTask* task = new JsonReaderPrivate::ReadTask(*d, data, errors);
+	return task->start(d->pool ? d->pool : QThreadPool::globalInstance());
+}
+
+class JSON::JsonReaderPrivate::BatchTask : public QRunnable {
+	public:
+		BatchTask(const JsonReaderPrivate& reader, const QList<QByteArray>& data,
+				  int first, int last, JsonArray::iterator values,
+				  QList<JsonReaderErrors>::iterator errors, bool keepErrors,
+				  QSemaphore* done)
+			:	reader(reader), data(data), first(first), last(last),
+				values(values), errors(errors), keepErrors(keepErrors),
+				done(done) { }
+
+		auto run() -> void override {
+			// the documents in a run share their buffers and keys
+			Scratch scratch(reader.keyTable);
+			for (int i = first; i < last; ++ i) {
+				values[i] = reader.parseMessage(data.at(i),
+												keepErrors ? &errors[i] : nullptr,
+												scratch);
 			}
-			break;
+			if (done) {
+				done->release();
+			}
+		}
+
+	private:
+		const JsonReaderPrivate& reader;
+		const QList<QByteArray>& data;
+		int first;
+		int last;
+		// where the values and errors of the whole batch go
+		JsonArray::iterator values;
+		QList<JsonReaderErrors>::iterator errors;
+		bool keepErrors;
+		// `nullptr` when run on the thread waiting for the batch
+		QSemaphore* done;
+};
+
+auto JsonReader::parseBatch(QList<QByteArray> data,
+							QList<JsonReaderErrors>* errors) const -> JsonArray {
+	QThreadPool* threads = d->pool ? d->pool : QThreadPool::globalInstance();
+
+	// every slot is filled in by exactly one run, so the lists
+	// are only ever written to at different places at once
+	JsonArray values;
+	QList<JsonReaderErrors> found;
+	JsonValue null(JsonValue::Null);
+	JsonReaderErrors none;
+	values.reserve(data.size());
+	for (int i = 0; i < data.size(); ++ i) {
+		values.append(null);
+		if (errors) {
+			found.append(none);
+		}
+	}
+
+	// a few runs for every thread, but none so short that
+	// handing it over costs more than parsing it
+	qint64 total = 0;
+	for (const QByteArray& text : data) {
+		total += text.size();
+	}
+	qint64 target = qMax(qint64(JsonReaderPrivate::batchMinimum),
+						 total / (4 * qMax(1, threads->maxThreadCount())));
+	QVector<int> ends;
+	qint64 size = 0;
+	for (int i = 0; i < data.size(); ++ i) {
+		size += data.at(i).size();
+		if (size >= target || i == data.size() - 1) {
+			ends.append(i + 1);
+			size = 0;
+		}
+	}
+
+	// the first run is parsed on this thread while it waits
+	QSemaphore done;
+	for (int run = 1; run < ends.size(); ++ run) {
+		threads->start(new JsonReaderPrivate::BatchTask(
+						   *d, data, ends.at(run - 1), ends.at(run),
+						   values.begin(), found.begin(), errors, &done));
 	}
-	return ans;
+	if (!ends.isEmpty()) {
+		JsonReaderPrivate::BatchTask(*d, data, 0, ends.first(), values.begin(),
+									 found.begin(), errors, nullptr).run();
+	}
+	done.acquire(qMax(0, ends.size() - 1));
+
+	if (errors) {
+		*errors += found;
+	}
+	return values;
+}
+
+auto JsonReader::parse(QString string, QList<JsonPath> paths,
+					   JsonReaderErrors* errors) const -> JsonValue {
+	JsonReaderPrivate::Selection selection(paths);
+	if (d->zeroCopy) {
+		selection.builder.text = new JsonLazyText(string, d->keyTable);
+		d->parse(*selection.builder.text, selection, errors);
+	} else {
+		d->parse(string.utf16(), string.length(), selection, errors);
+	}
+	return selection.builder.result();
+}
+
+auto JsonReader::read(QIODevice* io, QList<JsonPath> paths,
+					  JsonReaderErrors* errors) const -> JsonValue {
+	JsonReaderPrivate::Selection selection(paths);
+	if (d->zeroCopy) {
+		selection.builder.text = d->keep(io, errors);
+		d->parse(*selection.builder.text, selection, errors);
+	} else {
+		d->read(io, selection, errors);
+	}
+	return selection.builder.result();
+}
+
+auto JsonReader::read(QTextStream& stream, QList<JsonPath> paths,
+					  JsonReaderErrors* errors) const -> JsonValue {
+	return parse(stream.readAll(), paths, errors);
+}
+
+auto JsonReader::parseDocument(QString string, JsonReaderErrors* errors) const -> JsonDocument {
+	QExplicitlySharedDataPointer<JsonArena> arena(new JsonArena);
+	JsonArenaBuilder builder(arena.data());
+	d->parse(string.utf16(), string.length(), builder, errors);
+	return JsonDocument(new JsonDocumentPrivate(arena, builder.result()));
 }
 
-auto JsonReaderPrivate::readString(QTextStream& stream,
-								   JsonReaderErrors* errors) const -> QString {
-	int offset = stream.pos();
-	QString ans;
-	QTextStream output(&ans);
-	QChar curr;
-	stream >> curr;
-	if (stream.status()) {
-		// error after reading the first quote
+auto JsonReader::readDocument(QIODevice* io, JsonReaderErrors* errors) const -> JsonDocument {
+	QExplicitlySharedDataPointer<JsonArena> arena(new JsonArena);
+	JsonArenaBuilder builder(arena.data());
+	d->read(io, builder, errors);
+	return JsonDocument(new JsonDocumentPrivate(arena, builder.result()));
+}
+
+auto JsonReader::readDocument(QTextStream& stream, JsonReaderErrors* errors) const -> JsonDocument {
+	return parseDocument(stream.readAll(), errors);
+}
+
+auto JsonReader::parse(QString string, JsonHandler& handler,
+					   JsonReaderErrors* errors) const -> bool {
+	return d->parse(string.utf16(), string.length(), handler, errors);
+}
+
+auto JsonReader::read(QIODevice* io, JsonHandler& handler,
+					  JsonReaderErrors* errors) const -> bool {
+	return d->read(io, handler, errors);
+}
+
+auto JsonReader::read(QTextStream& stream, JsonHandler& handler,
+					  JsonReaderErrors* errors) const -> bool {
+	return parse(stream.readAll(), handler, errors);
+}
+
+auto JsonReader::validate(QByteArray data, JsonReaderErrors* errors) const -> bool {
+	const uchar* text = reinterpret_cast<const uchar*>(data.constData());
+	int invalid = JsonStructuralIndex::findInvalidUtf8(text, data.size());
+	if (invalid >= 0) {
 		if (errors) {
-			errors->addError(JsonReaderError::StreamFailure,
-								offset);
+			errors->addError(JsonReaderError::InvalidUtf8, invalid);
 		}
-		return ans;
+		return false;
 	}
-	// get the next character afterward
-	stream >> curr;
-	while (!stream.status() && curr != '\"') {
-		ushort c = curr.unicode();
-		switch (c) {
-			case '\\':
-				stream >> curr;
-				c = curr.unicode();
-				switch (c) {
-					case '\"': // single quote
-						output << QChar('\"');
-						break;
-					case '\\': // backslash
-						output << QChar('\\');
-						break;
-					case '/': // forward slash
-						output << QChar('/');
-						break;
-					case 'b': // backspace
-						output << QChar('\b');
-						break;
-					case 'f': // formfeed
-						output << QChar('\f');
-						break;
-					case 'n': // newline
-						output << QChar('\n');
-						break;
-					case 'r': // linefeed
-						output << QChar('\r');
-						break;
-					case 't': // tab
-						output << QChar('\t');
-						break;
-					case 'u': // 4-letter unicode hex
-						// get the hex
-						bool good;
-						int hexOffset = stream.pos();
-						ushort number = stream.read(4).toInt(&good, 16);
-						if (!good) {
-							if (errors) {
-								errors->addError(JsonReaderError::StringWithBadHex,
-													hexOffset);
-							}
-							return ans;
-						}
-						// output the corresponding char
-						output << QChar(number);
-						break; 
-				} // end escape switch statement
-				break;
-			default: // some random character
-				output << curr;
-				break;
+	return d->validate(text, data.size(), errors);
+}
 
-		} // end main switch statement
+auto JsonReader::validate(QString string, JsonReaderErrors* errors) const -> bool {
+	return d->validate(string.utf16(), string.length(), errors);
+}
 
-		stream >> curr;
+auto JsonReaderPrivate::keep(QIODevice* io,
+							 JsonReaderErrors* errors) const -> QExplicitlySharedDataPointer<JsonLazyText> {
+	if (JsonInflateDevice::isCompressed(io)) {
+		JsonInflateDevice inflated(io);
+		QExplicitlySharedDataPointer<JsonLazyText> text = keep(&inflated, errors);
+		checkInflated(inflated, errors);
+		return text;
+	}
+	QByteArray bom = io->peek(2);
+	if (bom == "\xff\xfe" || bom == "\xfe\xff") {
+		QTextStream stream(io);
+		return QExplicitlySharedDataPointer<JsonLazyText>(
+			new JsonLazyText(stream.readAll(), keyTable));
+	}
+	return QExplicitlySharedDataPointer<JsonLazyText>(
+		new JsonLazyText(io->readAll(), keyTable));
+}
 
-	} // end while loop
+auto JsonReaderPrivate::checkInflated(const JsonInflateDevice& inflated,
+									  JsonReaderErrors* errors) -> bool {
+	if (!inflated.failed()) {
+		return true;
+	}
+	if (errors) {
+		errors->addError(JsonReaderError::StreamFailure,
+						 int(qMin(inflated.inflated(), qint64(INT_MAX))));
+	}
+	return false;
+}
 
-	// if we didn't reach the end of the string,
-	// signal the error
-	if (curr != '\"' && errors) {
-		errors->addError(JsonReaderError::StringWithNoClosingQuote,
-							offset);
+auto JsonReaderPrivate::readTree(QIODevice* io, JsonReaderErrors* errors,
+								 JsonReadWatch* watch, bool serial) const -> JsonValue {
+	if (lazy || zeroCopy) {
+		// the text has to be kept, so it is not mapped
+		return parseKept(keep(io, errors), errors, watch, serial);
 	}
+	TreeBuilder builder;
+	builder.watch = watch;
+	builder.serial = serial;
+	read(io, builder, errors);
+	return builder.result();
+}
 
-	return ans;
+auto JsonReaderPrivate::readFile(const QString& path, JsonReaderErrors* errors,
+								 JsonReadWatch* watch) const -> JsonValue {
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		if (errors) {
+			errors->addError(JsonReaderError::StreamFailure, 0);
+		}
+		return JsonValue::Null;
+	}
+	return readTree(&file, errors, watch);
 }
 
-auto JsonReaderPrivate::readNumber(QTextStream& stream,
-								   JsonReaderErrors* errors) const -> double {
-	int offset = stream.pos();
-	double ans;
-	stream >> ans;
-	if (stream.status() && !stream.atEnd() && errors) {
-		errors->addError(JsonReaderError::NumberWithBadCharacter,
-							offset);
+auto JsonReaderPrivate::parseKept(QExplicitlySharedDataPointer<JsonLazyText> text,
+								  JsonReaderErrors* errors,
+								  JsonReadWatch* watch, bool serial) const -> JsonValue {
+	text->views = zeroCopy;
+	if (lazy) {
+		return parseLazy(text, errors);
 	}
-	return ans;
+	TreeBuilder builder;
+	builder.text = text;
+	builder.watch = watch;
+	builder.serial = serial;
+	parse(*text, builder, errors);
+	return builder.result();
 }
 
-auto JsonReaderPrivate::readArray(QTextStream& stream,
-								  JsonReaderErrors* errors) const -> JsonArray {
-	JsonArray ans;
+auto JsonReaderPrivate::parseLazy(QExplicitlySharedDataPointer<JsonLazyText> text,
+								  JsonReaderErrors* errors) const -> JsonValue {
+	// the base handler ignores everything, so this only checks
+	JsonHandler check;
+	if (!parse(*text, check, errors)) {
+		// what comes before the mistake is read the usual way;
+		// the errors have already been reported
+		TreeBuilder builder;
+		if (text->views) {
+			builder.text = text;
+		}
+		parse(*text, builder, nullptr);
+		return builder.result();
+	}
+	return JsonLazyTextSpan::root(text);
+}
+
+template <class Char>
+auto JsonReaderPrivate::parseTree(const Char* data, int length, JsonReaderErrors* errors,
+								  Scratch* scratch) const -> JsonValue {
+	if (!scratch) {
+		TreeBuilder builder;
+		parse(data, length, builder, errors);
+		return builder.result();
+	}
+	// the builder's stack is kept for the next document
+	TreeBuilder& builder = scratch->builder;
+	parse(data, length, builder, errors, &scratch->keys, &scratch->index);
+	JsonValue value = builder.result();
+	builder.clear();
+	return value;
+}
+
+auto JsonReaderPrivate::parseUtf8(const uchar* data, int length, JsonReaderErrors* errors,
+								  Scratch* scratch) const -> JsonValue {
+	return parseTree(data, length, errors, scratch);
+}
+
+auto JsonReaderPrivate::parseMessage(const QByteArray& data, JsonReaderErrors* errors,
+									 Scratch& scratch) const -> JsonValue {
+	JsonValue value = parseBytes(data, errors ? &scratch.errors : nullptr, scratch);
+	handOver(scratch, errors);
+	return value;
+}
+
+auto JsonReaderPrivate::parseMessage(const QString& string, JsonReaderErrors* errors,
+									 Scratch& scratch) const -> JsonValue {
+	JsonReaderErrors* found = errors ? &scratch.errors : nullptr;
+	JsonValue value = lazy || zeroCopy
+		? parseKept(QExplicitlySharedDataPointer<JsonLazyText>(
+						new JsonLazyText(string, keyTable)), found, nullptr, true)
+		: parseTree(string.utf16(), string.length(), found, &scratch);
+	handOver(scratch, errors);
+	return value;
+}
+
+auto JsonReaderPrivate::parseBytes(const QByteArray& data, JsonReaderErrors* errors,
+								   Scratch& scratch) const -> JsonValue {
+	// looking at the first two bytes is enough to tell
+	QByteArray header = QByteArray::fromRawData(data.constData(), qMin(2, data.size()));
+	if (header == "\xff\xfe" || header == "\xfe\xff"
+			|| JsonInflateDevice::isCompressed(header)) {
+		QByteArray bytes = data;
+		QBuffer buffer(&bytes);
+		buffer.open(QIODevice::ReadOnly);
+		return readTree(&buffer, errors, nullptr, true);
+	}
+	if (lazy || zeroCopy) {
+		return parseKept(QExplicitlySharedDataPointer<JsonLazyText>(
+							 new JsonLazyText(data, keyTable)), errors, nullptr, true);
+	}
+	return parseTree(reinterpret_cast<const uchar*>(data.constData()),
+					 data.size(), errors, &scratch);
+}
 
-	// get rid of the first [
-	int arrayStart = stream.pos();
-	QChar curr;
-	stream >> curr;
+auto JsonReaderPrivate::handOver(Scratch& scratch, JsonReaderErrors* errors) -> void {
+	if (!errors) {
+		return;
+	}
+	// most documents have no errors, and they all share
+	// the one empty list; only a list with errors in it
+	// has to be replaced
+	*errors = scratch.errors;
+	if (scratch.errors.numErrors() > 0) {
+		scratch.errors = JsonReaderErrors();
+	}
+}
 
-	// now skip white space and comments
-	skipNonData(stream, errors);
-	if (errors && errors->numErrors()) {
-		return ans;
+template <class Handler>
+auto JsonReaderPrivate::read(QIODevice* io, Handler& handler,
+							 JsonReaderErrors* errors) const -> bool {
+	// compressed text is inflated on another thread while it
+	// is read, so only the text itself is ever held in full
+	if (JsonInflateDevice::isCompressed(io)) {
+		JsonInflateDevice inflated(io);
+		bool ans = read(&inflated, handler, errors);
+		return checkInflated(inflated, errors) && ans;
 	}
 
-	// check for empty array
-	stream >> curr;
-	if (curr == ']') {
-		return ans;
+	// UTF-16 and UTF-32 text still has to be decoded by
+	// QTextStream; everything else is read as UTF-8
+	QByteArray bom = io->peek(2);
+	if (bom == "\xff\xfe" || bom == "\xfe\xff") {
+		QTextStream stream(io);
+		QString text = stream.readAll();
+		return parse(text.utf16(), text.length(), handler, errors);
 	}
-	if (!stream.seek(stream.pos() - 1)) {
-		if (errors) {
-			errors->addError(JsonReaderError::StreamFailure,
-								stream.pos());
-		}
-		return ans;
-	}
-
-	// read in values until the ]
-	while (!stream.status()) {
-		// now skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
-		
-		// read in the value
-		JsonValue toAdd = readValue(stream, errors);
-		if (errors && errors->numErrors()) return ans;
-		ans << toAdd;
-
-		// skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
-
-		// get the next character
-		stream >> curr;
-		if (curr == ',') {
-			// skip to the next value
-			skipNonData(stream, errors);
-			if (errors && errors->numErrors()) return ans;
-
-			// get the next char
-			stream >> curr;
-			if (curr == ']') {
-				// , and ] can't happen next to each other
-				if (errors) {
-					errors->addError(JsonReaderError::ArrayWithExtraComma,
-										stream.pos());
-				}
-				return ans;
-			}
-			if (!stream.seek(stream.pos() - 1)) {
-				if (errors) {
-					errors->addError(JsonReaderError::StreamFailure,
-										stream.pos());
-				}
-				return ans;
+
+	// parse files straight out of the page cache
+	QFileDevice* file = qobject_cast<QFileDevice*>(io);
+	if (file && !file->isSequential()) {
+		qint64 start = file->pos();
+		qint64 size = file->size() - start;
+		uchar* mapped = nullptr;
+		if (size > 0 && size <= INT_MAX) {
+			mapped = file->map(start, size);
+		}
+		if (mapped) {
+			bool ans = parse(mapped, int(size), handler, errors);
+			file->unmap(mapped);
+			// leave the file where reading it would have
+			file->seek(start + size);
+			return ans;
+		}
+	}
+
+	// sockets, pipes, and files that could not be mapped
+	QByteArray bytes = io->readAll();
+	return parse(reinterpret_cast<const uchar*>(bytes.constData()),
+				 bytes.size(), handler, errors);
+}
+
+template <class Handler>
+auto JsonReaderPrivate::parse(const JsonLazyText& text, Handler& handler,
+							  JsonReaderErrors* errors) const -> bool {
+	if (text.utf8) {
+		return parse(reinterpret_cast<const uchar*>(text.bytes.constData()),
+					 text.bytes.size(), handler, errors);
+	}
+	return parse(text.text.utf16(), text.text.length(), handler, errors);
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::parse(const Char* data, int length, Handler& handler,
+							  JsonReaderErrors* errors, JsonKeyCache* keys,
+							  QVector<int>* index) const -> bool {
+	// records repeat the same few keys over and over,
+	// so each of them is only made into a string once
+	JsonKeyCache documentKeys(keyTable);
+	if (!keys) {
+		keys = &documentKeys;
+	}
+
+	// a byte order mark is not part of the text, but it
+	// still counts towards the offsets
+	int bom = byteOrderMarkLength(data, length);
+	if (pool && length - bom >= parallelMinimum
+			&& parseParallel(data, length, bom, handler)) {
+		return true;
+	}
+	if (engine == JsonReader::StructuralIndexEngine) {
+		QVector<int> documentIndex;
+		if (!index) {
+			index = &documentIndex;
+		}
+		if (JsonStructuralIndex::build(data + bom, length - bom, *index)) {
+			IndexCursor<Char> cursor(data + bom, length - bom, *index);
+			cursor.keys = keys;
+			readIndexedValue(cursor, handler);
+			if (!cursor.failed) {
+				return true;
 			}
-		} else {
-			if (curr != ']') {
-				// wasn't a separator,
-				// so we had to be done
+			if (cursor.stoppedAt >= 0) {
 				if (errors) {
-					errors->addError(JsonReaderError::ArrayWithNoClosingBracket,
-										arrayStart);
+					errors->addError(JsonReaderError::StoppedByHandler,
+									 bom + cursor.stoppedAt);
 				}
-				return ans;
+				return false;
 			}
-			break;
+			// a mistake somewhere; the character by character
+			// reader pins it down
+			return parseText(data, length, bom, restart(handler), errors, keys);
 		}
-		// move back, since that char is important
-		if (!stream.seek(stream.pos() - 1)) {
-			if (errors) {
-				errors->addError(JsonReaderError::StreamFailure,
-									stream.pos());
+		// comments, or a string that never ends; the character
+		// by character reader handles the former and reports
+		// the latter
+	}
+	return parseText(data, length, bom, handler, errors, keys);
+}
+
+template <class Char>
+auto JsonReaderPrivate::validate(const Char* data, int length,
+								 JsonReaderErrors* errors) const -> bool {
+	// always one character at a time; the structural index engine
+	// would need an index, and a second pass to check it
+	Validator validator;
+	return parseText(data, length, byteOrderMarkLength(data, length),
+					 validator, errors, nullptr);
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::parseText(const Char* data, int length, int bom,
+								  Handler& handler, JsonReaderErrors* errors,
+								  JsonKeyCache* keys) const -> bool {
+	switch (dialect) {
+		case JsonReader::StrictDialect:
+			return parseText(data, length, bom, handler, errors, keys, JsonStrictDialect());
+		case JsonReader::RelaxedDialect:
+			return parseText(data, length, bom, handler, errors, keys, JsonRelaxedDialect());
+		default:
+			return parseText(data, length, bom, handler, errors, keys, JsonCommentDialect());
+	}
+}
+
+template <class Char, class Handler, class Dialect>
+auto JsonReaderPrivate::parseText(const Char* data, int length, int bom,
+								  Handler& handler, JsonReaderErrors* errors,
+								  JsonKeyCache* keys, Dialect) const -> bool {
+	Cursor<Char, Dialect> cursor(data, length, errors);
+	cursor.pos += bom;
+	cursor.keys = keys;
+	// skip preceding white space and comments
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) {
+		return false;
+	}
+	// read in the value
+	readValue(cursor, handler);
+	return !cursor.failed;
+}
+
+JsonReaderPrivate::Selection::Selection(const QList<JsonPath>& paths)
+	:	nodes(1) {
+	for (const JsonPath& path : paths) {
+		int node = 0;
+		for (const JsonKey& key : path) {
+			// a key like "1" can be an object key or an array
+			// index, and either way it leads to the same place
+			int next = -1;
+			if (key.isObjectKey()) {
+				next = nodes.at(node).keys.value(key.toObjectKey(), -1);
 			}
-			return ans;
+			if (next < 0 && key.isArrayIndex()) {
+				next = nodes.at(node).indices.value(key.toArrayIndex(), -1);
+			}
+			if (next < 0) {
+				next = nodes.size();
+				nodes.append(Node());
+			}
+			if (key.isObjectKey()) {
+				nodes[node].keys.insert(key.toObjectKey(), next);
+			}
+			if (key.isArrayIndex()) {
+				nodes[node].indices.insert(key.toArrayIndex(), next);
+			}
+			node = next;
 		}
+		nodes[node].whole = true;
 	}
+}
 
-	return ans;
+auto JsonReaderPrivate::Selection::child(int node, const QString& key) const -> int {
+	return nodes.at(node).keys.value(key, -1);
 }
 
-auto JsonReaderPrivate::readObject(QTextStream& stream,
-								   JsonReaderErrors* errors) const -> JsonObject {
-	JsonObject ans;
-	
-	// get rid of the first {
-	int objectStart = stream.pos();
-	QChar curr;
-	stream >> curr;
+auto JsonReaderPrivate::Selection::child(int node, int index) const -> int {
+	return nodes.at(node).indices.value(index, -1);
+}
 
-	// now skip white space/comments
-	skipNonData(stream, errors);
-	if (errors && errors->numErrors()) return ans;
+template <class Char>
+auto JsonReaderPrivate::parse(const Char* data, int length, Selection& selection,
+							  JsonReaderErrors* errors) const -> bool {
+	switch (dialect) {
+		case JsonReader::StrictDialect:
+			return parse(data, length, selection, errors, JsonStrictDialect());
+		case JsonReader::RelaxedDialect:
+			return parse(data, length, selection, errors, JsonRelaxedDialect());
+		default:
+			return parse(data, length, selection, errors, JsonCommentDialect());
+	}
+}
 
-	// check for empty object
-	stream >> curr;
-	if (curr == '}') {
-		return ans;
+template <class Char, class Dialect>
+auto JsonReaderPrivate::parse(const Char* data, int length, Selection& selection,
+							  JsonReaderErrors* errors, Dialect) const -> bool {
+	// the skipping needs the text itself, so this
+	// is always read one character at a time
+	JsonKeyCache keys(keyTable);
+	Cursor<Char, Dialect> cursor(data, length, errors);
+	cursor.pos += byteOrderMarkLength(data, length);
+	cursor.keys = &keys;
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) {
+		return false;
 	}
-	if (!stream.seek(stream.pos() - 1)) {
-		if (errors) {
-			errors->addError(JsonReaderError::StreamFailure,
-								stream.pos());
+	readSelectedValue(cursor, selection, 0, 0);
+	return !cursor.failed;
+}
+
+template <class Char>
+class JSON::JsonReaderPrivate::SegmentTask : public QRunnable {
+	public:
+		SegmentTask(const JsonReaderPrivate& reader, const Char* data,
+					int length, int from, Segment& segment)
+			:	reader(reader), data(data), length(length),
+				from(from), segment(segment) { }
+
+		auto run() -> void override {
+			// a place to start is usually close by, so
+			// only look so far for one
+			int to = qMin(segment.until, from + (parallelMinimum >> 4));
+			segment.start = guessElementStart(data, from, to);
+			if (segment.start >= 0) {
+				reader.readSegment(data, length, segment);
+			}
+			segment.done.release();
 		}
-		return ans;
+
+	private:
+		const JsonReaderPrivate& reader;
+		const Char* data;
+		int length;
+		int from;
+		Segment& segment;
+};
+
+template <class Char>
+auto JsonReaderPrivate::parseParallel(const Char* data, int length, int bom,
+									  TreeBuilder& builder) const -> bool {
+	// a watched read goes in order, so it can say how far it got;
+	// it, and a document of a batch, is on the pool already, too,
+	// and may be all of it, leaving no thread for the segments
+	if (builder.watch || builder.serial) {
+		return false;
 	}
 
-	// read in values until the }
-	while (!stream.status()) {
-		// now skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+	// find the first element of the array; comments around
+	// it are left to the usual engines
+	Cursor<Char, JsonStrictDialect> cursor(data, length, nullptr);
+	cursor.pos += bom;
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed || cursor.peek() != '[') {
+		return false;
+	}
+	cursor.advance();
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed || cursor.peek() == ']') {
+		return false;
+	}
+	int first = cursor.offset();
 
-		// read in the key
-		QString key = readString(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+	// a few segments per thread evens out the work
+	int count = qMin(4 * qMax(1, pool->maxThreadCount()),
+					 (length - first) / (parallelMinimum >> 2));
+	if (count < 2) {
+		return false;
+	}
+	QScopedArrayPointer<Segment> segments(new Segment[count]);
+	for (int i = 0; i < count; ++ i) {
+		segments[i].text = builder.text;
+		segments[i].until = i + 1 < count
+			? first + int(qint64(length - first) * (i + 1) / count)
+			: length;
+	}
 
-		// now skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+	// the first segment starts in the right place for sure
+	// and is read on this thread while the others are guessed
+	for (int i = 1; i < count; ++ i) {
+		pool->start(new SegmentTask<Char>(*this, data, length,
+										  segments[i - 1].until, segments[i]));
+	}
+	segments[0].start = first;
+	readSegment(data, length, segments[0]);
+
+	// join the segments, checking that each one starts where
+	// the one before it really ended; every segment has to be
+	// waited for, since the tasks are still using them
+	JsonArray values;
+	int pos = first;
+	bool closed = false;
+	bool ok = true;
+	for (int i = 0; i < count; ++ i) {
+		Segment& segment = segments[i];
+		if (i > 0) {
+			segment.done.acquire();
+		}
+		if (!ok || closed || (pos >= segment.until && i + 1 < count)) {
+			continue;
+		}
+		if (!segment.ok || segment.start != pos) {
+			// a wrong guess, so read this part again
+			// from where the last segment ended
+			segment.start = pos;
+			segment.closed = false;
+			readSegment(data, length, segment);
+			if (!segment.ok) {
+				// a mistake; the usual engines report it
+				ok = false;
+				continue;
+			}
+		}
+		values += segment.values;
+		pos = segment.end;
+		closed = segment.closed;
+	}
+	if (!ok || !closed) {
+		return false;
+	}
+	return builder.array(values);
+}
 
-		// read in the :
-		stream >> curr;
-		if (curr != ':') {
-			if (errors) {
-				errors->addError(JsonReaderError::ObjectWithMissingColon,
-									stream.pos());
+template <class Char>
+auto JsonReaderPrivate::parseParallel(const Char*, int, int,
+									  JsonHandler&) const -> bool {
+	// handlers expect their events in order
+	return false;
+}
+
+template <class Char>
+auto JsonReaderPrivate::parseParallel(const Char*, int, int,
+									  JsonArenaBuilder&) const -> bool {
+	// the segments would each need an arena of their own
+	return false;
+}
+
+template <class Char>
+auto JsonReaderPrivate::readSegment(const Char* data, int length,
+									Segment& segment) const -> void {
+	switch (dialect) {
+		case JsonReader::StrictDialect:
+			readSegment(data, length, segment, JsonStrictDialect());
+			return;
+		case JsonReader::RelaxedDialect:
+			readSegment(data, length, segment, JsonRelaxedDialect());
+			return;
+		default:
+			readSegment(data, length, segment, JsonCommentDialect());
+			return;
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readSegment(const Char* data, int length,
+									Segment& segment, Dialect) const -> void {
+	// each thread has to have keys of its own
+	JsonKeyCache keys(keyTable);
+	Cursor<Char, Dialect> cursor(data, length, nullptr);
+	cursor.pos += segment.start;
+	cursor.keys = &keys;
+	TreeBuilder builder;
+	builder.text = segment.text;
+	builder.startArray();
+	segment.ok = false;
+
+	// the same as readValue() for an array, but stopping after `until`
+	while (true) {
+		readValue(cursor, builder, 1);
+		if (cursor.failed) return;
+
+		JsonLexer::skipNonData(cursor);
+		if (cursor.failed) return;
+
+		ushort c = cursor.peek();
+		if (c == ',') {
+			// the guesses look for the first comma from `until` on
+			int comma = cursor.offset();
+			cursor.advance();
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed || cursor.peek() == ']') return;
+			if (comma >= segment.until) {
+				break;
 			}
+		} else if (c == ']') {
+			cursor.advance();
+			segment.closed = true;
 			break;
+		} else {
+			return;
 		}
+	}
+	segment.end = cursor.offset();
+	segment.values = builder.result().toArray();
+	segment.ok = true;
+}
 
-		// now skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+template <class Char>
+auto JsonReaderPrivate::guessElementStart(const Char* data, int from, int to) -> int {
+	// a quote followed by one of :,]} most likely ends a string,
+	// so `from` was inside of one; otherwise it was not
+	int pos = from;
+	for (int i = from; i < to; ++ i) {
+		if (data[i] == '\\') {
+			++ i;
+		} else if (data[i] == '\"') {
+			int next = i + 1;
+			while (next < to && (data[next] == ' ' || data[next] == '\t'
+								 || data[next] == '\n' || data[next] == '\r')) {
+				++ next;
+			}
+			ushort c = next < to ? data[next] : 0;
+			if (c == ':' || c == ',' || c == ']' || c == '}') {
+				pos = i + 1;
+			}
+			break;
+		}
+	}
 
-		// read in the value
-		JsonValue value = readValue(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+	// the top-level array is where the depth is the lowest, so the
+	// first comma at the lowest depth most likely separates two of
+	// its elements
+	int depth = 0;
+	int lowest = INT_MAX;
+	int comma = -1;
+	bool inString = false;
+	for (int i = pos; i < to; ++ i) {
+		ushort c = data[i];
+		if (inString) {
+			if (c == '\\') {
+				++ i;
+			} else if (c == '\"') {
+				inString = false;
+			}
+			continue;
+		}
+		switch (c) {
+			case '\"':
+				inString = true;
+				break;
+			case '[': case '{':
+				++ depth;
+				break;
+			case ']': case '}':
+				-- depth;
+				break;
+			case ',':
+				if (depth < lowest) {
+					lowest = depth;
+					comma = i;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	if (comma < 0) {
+		return -1;
+	}
+
+	// the element starts after the white space
+	pos = comma + 1;
+	while (pos < to && (data[pos] == ' ' || data[pos] == '\t'
+						|| data[pos] == '\n' || data[pos] == '\r')) {
+		++ pos;
+	}
+	return pos;
+}
+
+auto JsonReaderPrivate::restart(TreeBuilder& builder) -> TreeBuilder& {
+	// start over
+	builder.clear();
+	return builder;
+}
 
-		// add key-value pair
-		ans.insert(key, value);
+auto JsonReaderPrivate::restart(JsonArenaBuilder& builder) -> JsonArenaBuilder& {
+	// start over; what was already put in the arena stays there
+	builder.clear();
+	return builder;
+}
 
-		// now skip white space/comments
-		skipNonData(stream, errors);
-		if (errors && errors->numErrors()) return ans;
+auto JsonReaderPrivate::restart(JsonHandler&) -> JsonHandler& {
+	// the handler has already seen everything up to the mistake
+	static JsonHandler ignore;
+	return ignore;
+}
 
-		// check the next character
-		stream >> curr;
-		if (curr == ',') {
-			// now skip white space/comments
-			skipNonData(stream, errors);
-			if (errors && errors->numErrors()) return ans;
+template <class Char, class Dialect, class Handler>
+auto JsonReaderPrivate::readValue(Cursor<Char, Dialect>& cursor, Handler& handler,
+								  int depth) const -> void {
+	// the arrays and objects around the current value, innermost
+	// last; keeping them here rather than on the call stack means
+	// that deep documents can not use it up
+	QVarLengthArray<Container, 32> open;
+	while (true) {
+		ushort first = cursor.peek();
+		if (first != '[' && first != '{') {
+			readScalar(cursor, handler);
+			if (cursor.failed) return;
+		} else {
+			bool isObject = first == '{';
+			ushort close = isObject ? '}' : ']';
+			int start = cursor.offset();
+			if (maxDepth > 0 && depth + open.size() >= maxDepth) {
+				cursor.error(JsonReaderError::NestingTooDeep, start);
+				return;
+			}
+			// get rid of the [ or {
+			cursor.advance();
+			cursor.handled(isObject ? handler.startObject() : handler.startArray(), start);
+			if (cursor.failed) return;
+
+			// now skip white space and comments
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed) return;
+
+			if (cursor.peek() != close) {
+				// read the first value
+				open.append(Container(isObject, start));
+				if (isObject) {
+					readMember(cursor, handler);
+					if (cursor.failed) return;
+				}
+				continue;
+			}
+			// an empty array or object
+			cursor.handled(isObject ? handler.endObject() : handler.endArray(),
+						   cursor.offset());
+			cursor.advance();
+			if (cursor.failed) return;
+		}
+
+		// a whole value has been read, so move on to the next
+		// one, closing the arrays and objects that end first
+		while (true) {
+			if (open.isEmpty()) {
+				return;
+			}
+			const Container& container = open.last();
+			ushort close = container.isObject ? '}' : ']';
+
+			// skip white space/comments
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed) return;
 
 			// check the next character
-			stream >> curr;
-			if (curr == '}') {
-				// , and } can't happen next to each other
-				if (errors) {
-					errors->addError(JsonReaderError::ObjectWithExtraComma,
-										stream.pos());
+			ushort c = cursor.peek();
+			if (c == ',') {
+				if (!reached(handler, cursor.offset(), int(cursor.end - cursor.begin))) {
+					cursor.handled(false, cursor.offset());
+					return;
+				}
+				// skip to the next value
+				cursor.advance();
+				JsonLexer::skipNonData(cursor);
+				if (cursor.failed) return;
+
+				if (cursor.peek() == close) {
+					if (Dialect::trailingCommas) {
+						// closed below, as if the comma were not there
+						continue;
+					}
+					// , and ] or } can't happen next to each other
+					cursor.error(container.isObject
+									? JsonReaderError::ObjectWithExtraComma
+									: JsonReaderError::ArrayWithExtraComma,
+								 cursor.offset() + 1);
+					return;
+				}
+				if (container.isObject) {
+					readMember(cursor, handler);
+					if (cursor.failed) return;
 				}
-				return ans;
+				break;
 			}
-			if (!stream.seek(stream.pos() - 1)) {
-				if (errors) {
-					errors->addError(JsonReaderError::StreamFailure,
-										stream.pos());
+			if (c == close) {
+				cursor.handled(container.isObject ? handler.endObject() : handler.endArray(),
+							   cursor.offset());
+				cursor.advance();
+				open.removeLast();
+				if (cursor.failed) return;
+				continue;
+			}
+			// wasn't a separator, so we had to be done
+			cursor.error(container.isObject
+							? JsonReaderError::ObjectWithNoClosingBrace
+							: JsonReaderError::ArrayWithNoClosingBracket,
+						 container.start);
+			return;
+		}
+	}
+}
+
+template <class Char, class Dialect, class Handler>
+auto JsonReaderPrivate::readScalar(Cursor<Char, Dialect>& cursor,
+								   Handler& handler) const -> void {
+	int offset = cursor.offset();
+	// determine what to do based on the first char
+	switch (cursor.peek()) {
+		case '\"': // string
+			readStringValue(cursor, handler);
+			return;
+		case '0': case '1': case '2':
+		case '3': case '4': case '5':
+		case '6': case '7': case '8':
+		case '9': case '-': { // numbers
+			JsonNumber number = JsonLexer::readNumber(cursor);
+			if (!cursor.failed) {
+				cursor.handled(number.handle(handler), offset);
+			}
+			return;
+		}
+		case 'f': // false
+			if (JsonLexer::readLiteral(cursor, "false")) {
+				cursor.handled(handler.boolean(false), offset);
+				return;
+			}
+			break;
+		case 't': // true
+			if (JsonLexer::readLiteral(cursor, "true")) {
+				cursor.handled(handler.boolean(true), offset);
+				return;
+			}
+			break;
+		case 'n': // null
+			if (JsonLexer::readLiteral(cursor, "null")) {
+				cursor.handled(handler.null(), offset);
+				return;
+			}
+			break;
+		default: // unrecognizable
+			break;
+	}
+	// the offset is one past the start, as it always has been
+	cursor.error(JsonReaderError::UnknownLiteral, offset + 1);
+}
+
+template <class Char, class Dialect, class Handler>
+auto JsonReaderPrivate::readMember(Cursor<Char, Dialect>& cursor,
+								   Handler& handler) const -> void {
+	if (cursor.peek() != '\"') {
+		// has to be a string
+		cursor.error(JsonReaderError::ObjectWithNonStringKey,
+					 cursor.offset() + 1);
+		return;
+	}
+
+	// read in the key
+	int keyStart = cursor.offset();
+	QString key = readKey(cursor, handler);
+	if (cursor.failed) return;
+
+	// now skip white space/comments
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) return;
+
+	// read in the :
+	if (cursor.peek() != ':') {
+		cursor.error(JsonReaderError::ObjectWithMissingColon,
+					 cursor.offset() + 1);
+		return;
+	}
+	cursor.advance();
+	cursor.handled(handler.key(key), keyStart);
+	if (cursor.failed) return;
+
+	// now skip white space/comments
+	JsonLexer::skipNonData(cursor);
+}
+
+template <class Char, class Dialect, class Handler>
+auto JsonReaderPrivate::readKey(Cursor<Char, Dialect>& cursor, Handler&) -> QString {
+	return JsonLexer::readKey(cursor);
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readKey(Cursor<Char, Dialect>& cursor, Validator&) -> QString {
+	JsonLexer::checkString(cursor);
+	return QString();
+}
+
+template <class Char, class Dialect, class Handler>
+auto JsonReaderPrivate::readStringValue(Cursor<Char, Dialect>& cursor, Handler& handler) -> void {
+	int offset = cursor.offset();
+	QString string = JsonLexer::readString(cursor);
+	if (!cursor.failed) {
+		cursor.handled(handler.string(string), offset);
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readStringValue(Cursor<Char, Dialect>& cursor, TreeBuilder& builder) -> void {
+	const Char* start;
+	int length;
+	if (builder.text && JsonLexer::readPlainString(cursor, start, length)) {
+		builder.view(start, length);
+		return;
+	}
+	QString string = JsonLexer::readString(cursor);
+	if (!cursor.failed) {
+		builder.string(string);
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readStringValue(Cursor<Char, Dialect>& cursor, JsonArenaBuilder& builder) -> void {
+	const Char* start;
+	int length;
+	if (JsonLexer::readPlainString(cursor, start, length)) {
+		builder.plain(start, length);
+		return;
+	}
+	QString string = JsonLexer::readString(cursor);
+	if (!cursor.failed) {
+		builder.string(string);
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readStringValue(Cursor<Char, Dialect>& cursor, Validator&) -> void {
+	JsonLexer::checkString(cursor);
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readSelectedValue(Cursor<Char, Dialect>& cursor, Selection& selection,
+										  int node, int depth) const -> void {
+	if (selection.nodes.at(node).whole) {
+		readValue(cursor, selection.builder, depth);
+		return;
+	}
+	ushort first = cursor.peek();
+	if ((first == '{' || first == '[') && maxDepth > 0 && depth >= maxDepth) {
+		cursor.error(JsonReaderError::NestingTooDeep, cursor.offset());
+		return;
+	}
+	switch (first) {
+		case '{':
+			readSelectedObject(cursor, selection, node, depth);
+			return;
+		case '[':
+			readSelectedArray(cursor, selection, node, depth);
+			return;
+		default:
+			// the paths go further than this value does
+			JsonLexer::skipValue(cursor);
+			return;
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readSelectedArray(Cursor<Char, Dialect>& cursor, Selection& selection,
+										  int node, int depth) const -> void {
+	// the same as readValue() for an array, but skipping what is not selected
+	int arrayStart = cursor.offset();
+	cursor.advance();
+	selection.builder.startArray();
+
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) return;
+
+	if (cursor.peek() == ']') {
+		selection.builder.endArray();
+		cursor.advance();
+		return;
+	}
+
+	// the elements before a selected one are
+	// filled in with null to keep the indices
+	int index = 0;
+	int kept = 0;
+	while (true) {
+		int next = selection.child(node, index);
+		if (next < 0) {
+			JsonLexer::skipValue(cursor);
+		} else {
+			for (; kept < index; ++ kept) {
+				selection.builder.null();
+			}
+			readSelectedValue(cursor, selection, next, depth + 1);
+			++ kept;
+		}
+		if (cursor.failed) return;
+		++ index;
+
+		JsonLexer::skipNonData(cursor);
+		if (cursor.failed) return;
+
+		ushort c = cursor.peek();
+		if (c == ',') {
+			cursor.advance();
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed) return;
+
+			if (cursor.peek() == ']') {
+				if (Dialect::trailingCommas) {
+					selection.builder.endArray();
+					cursor.advance();
+					return;
 				}
-				return ans;
+				cursor.error(JsonReaderError::ArrayWithExtraComma,
+							 cursor.offset() + 1);
+				return;
 			}
+		} else if (c == ']') {
+			selection.builder.endArray();
+			cursor.advance();
+			return;
 		} else {
-			if (curr != '}') {
-				// since there was no comma,
-				// we had to be done
-				if (errors) {
-					errors->addError(JsonReaderError::ObjectWithNoClosingBrace,
-										objectStart);
+			cursor.error(JsonReaderError::ArrayWithNoClosingBracket,
+						 arrayStart);
+			return;
+		}
+	}
+}
+
+template <class Char, class Dialect>
+auto JsonReaderPrivate::readSelectedObject(Cursor<Char, Dialect>& cursor, Selection& selection,
+										   int node, int depth) const -> void {
+	// the same as readValue() for an object, but skipping what is not selected
+	int objectStart = cursor.offset();
+	cursor.advance();
+	selection.builder.startObject();
+
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) return;
+
+	if (cursor.peek() == '}') {
+		selection.builder.endObject();
+		cursor.advance();
+		return;
+	}
+
+	while (true) {
+		if (cursor.peek() != '\"') {
+			cursor.error(JsonReaderError::ObjectWithNonStringKey,
+						 cursor.offset() + 1);
+			return;
+		}
+
+		QString key = JsonLexer::readKey(cursor);
+		if (cursor.failed) return;
+
+		JsonLexer::skipNonData(cursor);
+		if (cursor.failed) return;
+
+		if (cursor.peek() != ':') {
+			cursor.error(JsonReaderError::ObjectWithMissingColon,
+						 cursor.offset() + 1);
+			return;
+		}
+		cursor.advance();
+
+		JsonLexer::skipNonData(cursor);
+		if (cursor.failed) return;
+
+		int next = selection.child(node, key);
+		if (next < 0) {
+			JsonLexer::skipValue(cursor);
+		} else {
+			selection.builder.key(key);
+			readSelectedValue(cursor, selection, next, depth + 1);
+		}
+		if (cursor.failed) return;
+
+		JsonLexer::skipNonData(cursor);
+		if (cursor.failed) return;
+
+		ushort c = cursor.peek();
+		if (c == ',') {
+			cursor.advance();
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed) return;
+
+			if (cursor.peek() == '}') {
+				if (Dialect::trailingCommas) {
+					selection.builder.endObject();
+					cursor.advance();
+					return;
 				}
+				cursor.error(JsonReaderError::ObjectWithExtraComma,
+							 cursor.offset() + 1);
+				return;
 			}
-			break;
+		} else if (c == '}') {
+			selection.builder.endObject();
+			cursor.advance();
+			return;
+		} else {
+			cursor.error(JsonReaderError::ObjectWithNoClosingBrace,
+						 objectStart);
+			return;
 		}
-		if (curr != '\"') {
-			// has to be a string
-			if (errors) {
-				errors->addError(JsonReaderError::ObjectWithNonStringKey,
-									stream.pos());
+	}
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::readIndexedValue(IndexCursor<Char>& cursor,
+										 Handler& handler) const -> void {
+	// the same as readValue(); the errors are left to it, so
+	// this only has to notice them
+	QVarLengthArray<Container, 32> open;
+	while (true) {
+		ushort first = cursor.peek();
+		if (first != '[' && first != '{') {
+			readIndexedScalar(cursor, handler);
+			if (cursor.failed) return;
+		} else {
+			bool isObject = first == '{';
+			ushort close = isObject ? '}' : ']';
+			int start = *cursor.token;
+			if (maxDepth > 0 && open.size() >= maxDepth) {
+				cursor.failed = true;
+				return;
 			}
-			return ans;
-		} else if (!stream.seek(stream.pos() - 1)) {
-			// move back, since that char is important 
-			if (errors) {
-				errors->addError(JsonReaderError::StreamFailure,
-									stream.pos());
+			// get rid of the [ or {
+			cursor.handled(isObject ? handler.startObject() : handler.startArray(), start);
+			cursor.advance();
+			if (cursor.failed) return;
+
+			if (cursor.peek() != close) {
+				// read the first value
+				open.append(Container(isObject, start));
+				if (isObject) {
+					readIndexedMember(cursor, handler);
+					if (cursor.failed) return;
+				}
+				continue;
 			}
-			return ans;
+			// an empty array or object
+			cursor.handled(isObject ? handler.endObject() : handler.endArray(),
+						   *cursor.token);
+			cursor.advance();
+			if (cursor.failed) return;
 		}
-	}
 
-	return ans;
-}
-
-auto JsonReaderPrivate::skipNonData(QTextStream& stream,
-									JsonReaderErrors* errors) const -> void {
-	// skip preceding whitespace
-	stream.skipWhiteSpace();
-	int commentStart = stream.pos();
-	QChar curr;
-	stream >> curr;
-	while (!stream.status() && curr == '/') {
-		// get the comment type
-		stream >> curr;
-		if (curr == '/') {
-			// single line comment
-			// skip over the line
-			stream.readLine();
-		} else if (curr == '*') {
-			/* block comment */ 
-			// go until after the trailing */
-			QChar lastOne;
-			stream >> lastOne;
-			bool quitWell = false;
-			while (!stream.status()) {
-				if (lastOne == '*') {
-					stream >> lastOne;
-					if (lastOne == '/') {
-						quitWell = true;
-						break;
+		// move on to the next value, closing the
+		// arrays and objects that end first
+		while (true) {
+			if (open.isEmpty()) {
+				return;
+			}
+			const Container& container = open.last();
+			ushort close = container.isObject ? '}' : ']';
+			ushort c = cursor.peek();
+			if (c == ',') {
+				if (!reached(handler, *cursor.token, cursor.length)) {
+					cursor.handled(false, *cursor.token);
+					return;
+				}
+				cursor.advance();
+				if (cursor.peek() == close) {
+					if (dialect == JsonReader::RelaxedDialect) {
+						// closed below, as if the comma were not there
+						continue;
 					}
-				} else {
-					stream >> lastOne;
+					cursor.failed = true;
+					return;
 				}
-			}
-			if (!quitWell) {
-				if (errors) {
-					errors->addError(JsonReaderError::CommentWithNoEnd,
-										commentStart);
+				if (container.isObject) {
+					readIndexedMember(cursor, handler);
+					if (cursor.failed) return;
 				}
+				break;
+			}
+			if (c == close) {
+				cursor.handled(container.isObject ? handler.endObject() : handler.endArray(),
+							   *cursor.token);
+				cursor.advance();
+				open.removeLast();
+				if (cursor.failed) return;
+				continue;
 			}
+			cursor.failed = true;
+			return;
 		}
-		// skip white space
-		stream.skipWhiteSpace();
-		// get the next char
-		stream >> curr;
 	}
-	// unget the last char
-	if (!stream.seek(stream.pos() - 1)) {
-		if (errors) {
-			errors->addError(JsonReaderError::StreamFailure,
-								stream.pos());
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::readIndexedScalar(IndexCursor<Char>& cursor,
+										  Handler& handler) const -> void {
+	switch (cursor.peek()) {
+		case '\"': // string
+			readIndexedStringValue(cursor, handler);
+			return;
+		default:
+			break;
+	}
+	if (cursor.token == cursor.last) {
+		cursor.failed = true;
+		return;
+	}
+	// numbers and literals run up to the next token or white space,
+	// so reuse the character by character reader for them
+	int offset = *cursor.token;
+	Cursor<Char> scalar(cursor.data, cursor.length, nullptr);
+	scalar.pos += offset;
+	enum { Number, False, True, Null } type = Null;
+	JsonNumber number;
+	switch (scalar.peek()) {
+		case '0': case '1': case '2':
+		case '3': case '4': case '5':
+		case '6': case '7': case '8':
+		case '9': case '-': // numbers
+			number = JsonLexer::readNumber(scalar);
+			type = Number;
+			break;
+		case 'f': // false
+			scalar.failed = !JsonLexer::readLiteral(scalar, "false");
+			type = False;
+			break;
+		case 't': // true
+			scalar.failed = !JsonLexer::readLiteral(scalar, "true");
+			type = True;
+			break;
+		case 'n': // null
+			scalar.failed = !JsonLexer::readLiteral(scalar, "null");
+			break;
+		default: // unrecognizable
+			scalar.failed = true;
+			break;
+	}
+	// the token must end exactly where the scanner said it does,
+	// unless it is the whole value; anything after that is ignored
+	switch (cursor.token == cursor.first ? 0 : scalar.peek()) {
+		case 0: case ' ': case '\t': case '\n': case '\r':
+		case ',': case ']': case '}': case ':':
+		case '\"': case '[': case '{':
+			break;
+		default:
+			scalar.failed = true;
+			break;
+	}
+	cursor.failed = scalar.failed;
+	cursor.advance();
+	if (cursor.failed) {
+		return;
+	}
+	switch (type) {
+		case Number:
+			cursor.handled(number.handle(handler), offset);
+			break;
+		case False:
+			cursor.handled(handler.boolean(false), offset);
+			break;
+		case True:
+			cursor.handled(handler.boolean(true), offset);
+			break;
+		case Null:
+			cursor.handled(handler.null(), offset);
+			break;
+	}
+}
+
+template <class Char>
+auto JsonReaderPrivate::readIndexedString(IndexCursor<Char>& cursor) const -> QString {
+	// the index has both quotes of every string
+	int open = cursor.token[0];
+	int close = cursor.token[1];
+	cursor.token += 2;
+	const Char* start = cursor.data + open + 1;
+	const Char* end = cursor.data + close;
+	for (const Char* p = start; p < end; ++ p) {
+		if (*p == '\\') {
+			// decode the escapes the usual way
+			Cursor<Char> string(cursor.data, cursor.length, nullptr);
+			string.pos += open;
+			QString ans = JsonLexer::readString(string);
+			cursor.failed = string.failed;
+			return ans;
+		}
+	}
+	return toText(start, end - start);
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::readIndexedStringValue(IndexCursor<Char>& cursor,
+											   Handler& handler) const -> void {
+	int offset = *cursor.token;
+	QString string = readIndexedString(cursor);
+	if (!cursor.failed) {
+		cursor.handled(handler.string(string), offset);
+	}
+}
+
+template <class Char>
+auto JsonReaderPrivate::readIndexedStringValue(IndexCursor<Char>& cursor,
+											   TreeBuilder& builder) const -> void {
+	if (builder.text) {
+		const Char* start = cursor.data + cursor.token[0] + 1;
+		const Char* end = cursor.data + cursor.token[1];
+		const Char* p = start;
+		while (p < end && *p != '\\') {
+			++ p;
+		}
+		if (p == end) {
+			cursor.token += 2;
+			builder.view(start, int(end - start));
+			return;
+		}
+	}
+	QString string = readIndexedString(cursor);
+	if (!cursor.failed) {
+		builder.string(string);
+	}
+}
+
+template <class Char>
+auto JsonReaderPrivate::readIndexedStringValue(IndexCursor<Char>& cursor,
+											   JsonArenaBuilder& builder) const -> void {
+	const Char* start = cursor.data + cursor.token[0] + 1;
+	const Char* end = cursor.data + cursor.token[1];
+	const Char* p = start;
+	while (p < end && *p != '\\') {
+		++ p;
+	}
+	if (p == end) {
+		cursor.token += 2;
+		builder.plain(start, int(end - start));
+		return;
+	}
+	QString string = readIndexedString(cursor);
+	if (!cursor.failed) {
+		builder.string(string);
+	}
+}
+
+template <class Char>
+auto JsonReaderPrivate::readIndexedKey(IndexCursor<Char>& cursor) const -> QString {
+	if (!cursor.keys) {
+		return readIndexedString(cursor);
+	}
+	const Char* start = cursor.data + cursor.token[0] + 1;
+	const Char* end = cursor.data + cursor.token[1];
+	ushort bits = 0;
+	for (const Char* p = start; p < end; ++ p) {
+		if (*p == '\\') {
+			return readIndexedString(cursor);
 		}
+		bits |= *p;
+	}
+	cursor.token += 2;
+	if (bits < 0x80) {
+		return cursor.keys->key(start, int(end - start));
+	}
+	return toText(start, int(end - start));
+}
+
+template <class Char, class Handler>
+auto JsonReaderPrivate::readIndexedMember(IndexCursor<Char>& cursor,
+										  Handler& handler) const -> void {
+	if (cursor.peek() != '\"') {
+		cursor.failed = true;
+		return;
+	}
+	int keyStart = *cursor.token;
+	QString key = readIndexedKey(cursor);
+	if (cursor.failed) return;
+
+	if (cursor.peek() != ':') {
+		cursor.failed = true;
+		return;
 	}
+	cursor.advance();
+	cursor.handled(handler.key(key), keyStart);
 }
 
 // The rest of this deals with the specifics of the error classes
@@ -508,7 +1682,7 @@ class JSON::JsonReaderErrorPrivate : public QSharedData {
 		int offset;
 		QString message;
 
-		static const QString messages[16];
+		static const QString messages[19];
 };
 
 class JSON::JsonReaderErrorsPrivate : public QSharedData {
@@ -516,7 +1690,7 @@ class JSON::JsonReaderErrorsPrivate : public QSharedData {
 		QList<JsonReaderError> errors;
 };
 
-const QString JsonReaderErrorPrivate::messages[16] = {
+const QString JsonReaderErrorPrivate::messages[19] = {
 	"No Error; offset %1 specified",
 	"Misplaced character in number starting at %1.",
 	"Unrecognized escape sequence at %1.",
@@ -533,7 +1707,10 @@ const QString JsonReaderErrorPrivate::messages[16] = {
 	"Extra comma in array at %1.",
 	"Missing closing bracket to match one at %1.",
 	"Block comment starting at %1 does not have closing \"*/\"",
-	"The stream failed at offset %1."
+	"The stream failed at offset %1.",
+	"The handler stopped the reader at %1.",
+	"Arrays and objects nested too deeply at %1.",
+	"Invalid UTF-8 at %1."
 };
 
 JsonReaderError::JsonReaderError(JsonReaderError::ErrorType type,
@@ -0,0 +1,46 @@
+// header file
+#include <JsonDataTree/JsonReaderSession.h>
+
+// internal data
+#include <QSharedData>
+
+// the parser, and what it keeps
+#include "JsonReader_p.h"
+
+// private data class
+class JSON::JsonReaderSessionPrivate : public QSharedData {
+	public:
+		JsonReaderSessionPrivate(const JsonReaderPrivate& reader)
+			:	reader(reader), scratch(reader.keyTable) { }
+
+		// a copy, so the reader can change in the meantime
+		const JsonReaderPrivate reader;
+		JsonReaderPrivate::Scratch scratch;
+};
+
+using namespace JSON;
+
+JsonReaderSession::JsonReaderSession()
+	:	d(new JsonReaderSessionPrivate(JsonReaderPrivate())) { }
+
+JsonReaderSession::JsonReaderSession(const JsonReader& reader)
+	:	d(new JsonReaderSessionPrivate(*reader.d)) { }
+
+JsonReaderSession::JsonReaderSession(const JsonReaderSession& other)
+	:	d(other.d) { }
+
+JsonReaderSession::~JsonReaderSession() { }
+
+auto JsonReaderSession::operator= (const JsonReaderSession& other) -> JsonReaderSession& {
+	if (this == &other) return *this;
+	d = other.d;
+	return *this;
+}
+
+auto JsonReaderSession::parse(QByteArray data, JsonReaderErrors* errors) -> JsonValue {
+	return d->reader.parseMessage(data, errors, d->scratch);
+}
+
+auto JsonReaderSession::parse(QString string, JsonReaderErrors* errors) -> JsonValue {
+	return d->reader.parseMessage(string, errors, d->scratch);
+}
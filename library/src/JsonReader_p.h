@@ -0,0 +1,441 @@
+#ifndef JSON_READER_P_H
+#define JSON_READER_P_H
+
+// for the reader
+#include <JsonDataTree/JsonReader.h>
+#include <JsonDataTree/JsonPath.h>
+#include <QSharedData>
+#include <QVector>
+#include <QHash>
+#include <QVarLengthArray>
+#include <QSemaphore>
+
+class QThreadPool;
+
+// the tokens themselves
+#include "JsonLexer_p.h"
+
+// what the tokens are turned into
+#include "JsonTreeBuilder_p.h"
+
+// values that are read when first used
+#include "JsonLazyValue_p.h"
+
+// documents that keep their values in one block
+#include "JsonDocument_p.h"
+
+// compressed devices
+#include "JsonCompression_p.h"
+
+// Internal; not part of the public API.
+
+// private data class
+class JSON::JsonReaderPrivate : public QSharedData {
+	public:
+		// a read position in a contiguous buffer of text, for
+		// reading in the given dialect
+		template <class Char, class Dialect = JsonCommentDialect>
+		using Cursor = JsonCursor<Char, Dialect>;
+
+		// a read position in a structural index
+		template <class Char>
+		class IndexCursor {
+			public:
+				IndexCursor(const Char* data, int length,
+							const QVector<int>& index)
+					:	data(data), length(length),
+						first(index.constData()),
+						token(first),
+						last(index.constData() + index.size()),
+						keys(nullptr), failed(false), stoppedAt(-1) { }
+
+				// the character starting the current token, or 0
+				auto peek() const -> ushort {
+					return token < last ? data[*token] : 0;
+				}
+
+				auto advance() -> void {
+					++ token;
+				}
+
+				// the handler returns false to stop the parser
+				auto handled(bool more, int offset) -> void {
+					if (!more) {
+						failed = true;
+						stoppedAt = offset;
+					}
+				}
+
+				const Char* data;
+				int length;
+				const int* first;
+				const int* token;
+				const int* last;
+				// where object keys are looked up, if anywhere
+				JsonKeyCache* keys;
+				bool failed;
+				int stoppedAt;
+		};
+
+		// builds the values out of the events the parser emits
+		using TreeBuilder = JsonTreeBuilder;
+
+		// what the parser hands everything to when it only checks
+		// the text; strings and keys are never even decoded for it
+		class Validator {
+			public:
+				auto startObject() -> bool { return true; }
+				auto key(const QString&) -> bool { return true; }
+				auto endObject() -> bool { return true; }
+				auto startArray() -> bool { return true; }
+				auto endArray() -> bool { return true; }
+				auto string(const QString&) -> bool { return true; }
+				auto number(double) -> bool { return true; }
+				auto integer(qint64) -> bool { return true; }
+				auto unsignedInteger(quint64) -> bool { return true; }
+				auto boolean(bool) -> bool { return true; }
+				auto null() -> bool { return true; }
+		};
+
+		// what parsing a document needs besides the text itself;
+		// a session keeps it from one document to the next, so
+		// the buffers in it only grow the first few times
+		class Scratch {
+			public:
+				// batches and lines are parsed on the pool already,
+				// so their documents are never split up over it again
+				Scratch(JsonKeyTable* table = nullptr)
+					:	keys(table) {
+					builder.serial = true;
+				}
+
+				// the keys of every document parsed with this
+				JsonKeyCache keys;
+				// the structural index of the last document
+				QVector<int> index;
+				// only the stack in here is kept
+				TreeBuilder builder;
+				// empty unless the last document had errors
+				JsonReaderErrors errors;
+		};
+
+		// an array or object that is being read
+		class Container {
+			public:
+				Container(bool isObject = false, int start = 0)
+					:	isObject(isObject), start(start) { }
+
+				bool isObject;
+				// where its [ or { is
+				int start;
+		};
+
+		// the elements of a large array from about one place
+		// to about another, parsed on a thread in the pool
+		class Segment {
+			public:
+				Segment()
+					:	start(-1), until(0), end(0),
+						closed(false), ok(false) { }
+
+				// where the first element was guessed to be
+				int start;
+				// the last element is the one that crosses this
+				int until;
+				// just past the comma after the last element,
+				// or the closing bracket
+				int end;
+				bool closed;
+				bool ok;
+				JsonArray values;
+				// the text strings are left in, if they are
+				QExplicitlySharedDataPointer<JsonLazyText> text;
+
+				// released once the segment has been parsed
+				QSemaphore done;
+		};
+
+		// parses one segment on a thread in the pool
+		template <class Char>
+		class SegmentTask;
+
+		// reads a file or some text on a thread in the pool,
+		// for someone waiting on its future
+		class ReadTask;
+
+		// parses some of the documents of a batch, one after
+		// another, on a thread in the pool
+		class BatchTask;
+
+		// the paths a selective read keeps, as a tree of keys,
+		// and the values found along them
+		class Selection {
+			public:
+				class Node {
+					public:
+						Node()
+							:	whole(false) { }
+
+						// a path ends here, so everything under it is kept
+						bool whole;
+						// where each key or index leads
+						QHash<QString, int> keys;
+						QHash<int, int> indices;
+				};
+
+				Selection(const QList<JsonPath>& paths);
+
+				// the node `key` or `index` leads to, or -1
+				auto child(int node, const QString& key) const -> int;
+				auto child(int node, int index) const -> int;
+
+				// the root is the first node
+				QVector<Node> nodes;
+				TreeBuilder builder;
+		};
+
+		// arrays smaller than this are not worth splitting
+		static const int parallelMinimum = 1 << 20;
+
+		// the least text in a batch worth handing to another thread
+		static const int batchMinimum = 1 << 16;
+
+		JsonReaderPrivate()
+			:	engine(JsonReader::RecursiveDescentEngine),
+				dialect(JsonReader::CommentDialect),
+				pool(nullptr), lazy(false), zeroCopy(false), keyTable(nullptr),
+				maxDepth(JsonReader::DefaultMaxDepth) { }
+
+		JsonReader::Engine engine;
+		JsonReader::Dialect dialect;
+		QThreadPool* pool;
+		bool lazy;
+		bool zeroCopy;
+		JsonKeyTable* keyTable;
+		// no limit if this is 0 or less
+		int maxDepth;
+
+		// read all of a device into text that can be kept
+		auto keep(QIODevice* io,
+				  JsonReaderErrors* errors) const -> QExplicitlySharedDataPointer<JsonLazyText>;
+
+		// report a compressed stream that was cut short or corrupt
+		static auto checkInflated(const JsonInflateDevice& inflated,
+								  JsonReaderErrors* errors) -> bool;
+
+		// read an entire device into a value, the way the reader
+		// is set up to, telling `watch` how far it got if given;
+		// `serial` keeps it off the pool
+		auto readTree(QIODevice* io, JsonReaderErrors* errors,
+					  JsonReadWatch* watch = nullptr,
+					  bool serial = false) const -> JsonValue;
+
+		// read a file into a value the same way
+		auto readFile(const QString& path, JsonReaderErrors* errors,
+					  JsonReadWatch* watch = nullptr) const -> JsonValue;
+
+		// parse a document that is kept, lazily or leaving
+		// its strings in it, or both
+		auto parseKept(QExplicitlySharedDataPointer<JsonLazyText> text,
+					   JsonReaderErrors* errors,
+					   JsonReadWatch* watch = nullptr,
+					   bool serial = false) const -> JsonValue;
+
+		// check the whole document, then hand back a value whose
+		// arrays and objects are read from `text` when first used
+		auto parseLazy(QExplicitlySharedDataPointer<JsonLazyText> text,
+					   JsonReaderErrors* errors) const -> JsonValue;
+
+		// parse a buffer into a tree, with what is in `scratch`
+		// if given
+		template <class Char>
+		auto parseTree(const Char* data, int length, JsonReaderErrors* errors,
+					   Scratch* scratch = nullptr) const -> JsonValue;
+
+		// parse UTF-8 into a tree; the other readers share this
+		auto parseUtf8(const uchar* data, int length, JsonReaderErrors* errors,
+					   Scratch* scratch = nullptr) const -> JsonValue;
+
+		// parse one of many documents the way the reader is set up
+		// to, keeping `scratch` for the next one; `errors`, if
+		// given, is set to the errors in this one. Bytes are read
+		// as a device would be, but UTF-8 is parsed in place
+		auto parseMessage(const QByteArray& data, JsonReaderErrors* errors,
+						  Scratch& scratch) const -> JsonValue;
+		auto parseMessage(const QString& string, JsonReaderErrors* errors,
+						  Scratch& scratch) const -> JsonValue;
+
+		// parse the bytes of a message, the way parseMessage() does,
+		// with the errors added to `errors`
+		auto parseBytes(const QByteArray& data, JsonReaderErrors* errors,
+						Scratch& scratch) const -> JsonValue;
+
+		// hand the errors found in `scratch` over to `errors`
+		static auto handOver(Scratch& scratch, JsonReaderErrors* errors) -> void;
+
+		// read an entire device
+		template <class Handler>
+		auto read(QIODevice* io, Handler& handler,
+				  JsonReaderErrors* errors) const -> bool;
+
+		// parse all of a kept text
+		template <class Handler>
+		auto parse(const JsonLazyText& text, Handler& handler,
+				   JsonReaderErrors* errors) const -> bool;
+
+		// parse an entire buffer with the chosen engine; the keys
+		// are kept in `keys`, and the structural index in `index`,
+		// or in ones of their own if those are `nullptr`
+		template <class Char, class Handler>
+		auto parse(const Char* data, int length, Handler& handler,
+				   JsonReaderErrors* errors, JsonKeyCache* keys = nullptr,
+				   QVector<int>* index = nullptr) const -> bool;
+
+		// check that a buffer holds a well-formed document, with
+		// nothing being made out of it
+		template <class Char>
+		auto validate(const Char* data, int length,
+					  JsonReaderErrors* errors) const -> bool;
+
+		// parse an entire buffer one character at a time,
+		// starting after the byte order mark, in the reader's
+		// dialect or the given one
+		template <class Char, class Handler>
+		auto parseText(const Char* data, int length, int bom, Handler& handler,
+					   JsonReaderErrors* errors, JsonKeyCache* keys) const -> bool;
+		template <class Char, class Handler, class Dialect>
+		auto parseText(const Char* data, int length, int bom, Handler& handler,
+					   JsonReaderErrors* errors, JsonKeyCache* keys, Dialect) const -> bool;
+
+		// parse an entire buffer, only keeping what is on the
+		// selected paths and skipping everything else
+		template <class Char>
+		auto parse(const Char* data, int length, Selection& selection,
+				   JsonReaderErrors* errors) const -> bool;
+		template <class Char, class Dialect>
+		auto parse(const Char* data, int length, Selection& selection,
+				   JsonReaderErrors* errors, Dialect) const -> bool;
+
+		// parse a large top-level array on the pool; this gives up,
+		// leaving it to the usual engines, at any sign of trouble
+		template <class Char>
+		auto parseParallel(const Char* data, int length, int bom,
+						   TreeBuilder& builder) const -> bool;
+		template <class Char>
+		auto parseParallel(const Char* data, int length, int bom,
+						   JsonHandler& handler) const -> bool;
+		template <class Char>
+		auto parseParallel(const Char* data, int length, int bom,
+						   JsonArenaBuilder& builder) const -> bool;
+
+		// read the elements of a segment, starting at `start`
+		template <class Char>
+		auto readSegment(const Char* data, int length, Segment& segment) const -> void;
+		template <class Char, class Dialect>
+		auto readSegment(const Char* data, int length, Segment& segment, Dialect) const -> void;
+
+		// find what is most likely the start of an element of the
+		// top-level array, somewhere after `from`, without knowing
+		// whether `from` is inside a string; -1 if there is none
+		template <class Char>
+		static auto guessElementStart(const Char* data, int from, int to) -> int;
+
+		// the handler to use when the structural index engine gives
+		// up half way and the other engine has to pin down the error
+		static auto restart(TreeBuilder& builder) -> TreeBuilder&;
+		static auto restart(JsonHandler& handler) -> JsonHandler&;
+		static auto restart(JsonArenaBuilder& builder) -> JsonArenaBuilder&;
+
+		// called between the values of an array or object, with
+		// where the next one starts; only a tree builder can be
+		// watched, and it can stop the parser there
+		template <class Handler>
+		static auto reached(Handler&, int, int) -> bool {
+			return true;
+		}
+		static auto reached(TreeBuilder& builder, int offset, int length) -> bool {
+			return builder.reached(offset, length);
+		}
+
+		// read a value from the cursor, with all of the arrays and
+		// objects in it; `depth` arrays and objects are around it
+		template <class Char, class Dialect, class Handler>
+		auto readValue(Cursor<Char, Dialect>& cursor, Handler& handler,
+					   int depth = 0) const -> void;
+
+		// read a string, number, or literal from the cursor
+		template <class Char, class Dialect, class Handler>
+		auto readScalar(Cursor<Char, Dialect>& cursor, Handler& handler) const -> void;
+
+		// read an object key and the colon after it from the cursor
+		template <class Char, class Dialect, class Handler>
+		auto readMember(Cursor<Char, Dialect>& cursor, Handler& handler) const -> void;
+
+		// read an object key from the cursor for the handler; a
+		// validator only has it checked, and gets a null string
+		template <class Char, class Dialect, class Handler>
+		static auto readKey(Cursor<Char, Dialect>& cursor, Handler& handler) -> QString;
+		template <class Char, class Dialect>
+		static auto readKey(Cursor<Char, Dialect>& cursor, Validator& validator) -> QString;
+
+		// read a string value from the cursor and hand it on; a tree
+		// builder with the text gets strings without escapes as views,
+		// an arena builder decodes them into its arena itself, and a
+		// validator only has it checked
+		template <class Char, class Dialect, class Handler>
+		static auto readStringValue(Cursor<Char, Dialect>& cursor, Handler& handler) -> void;
+		template <class Char, class Dialect>
+		static auto readStringValue(Cursor<Char, Dialect>& cursor, TreeBuilder& builder) -> void;
+		template <class Char, class Dialect>
+		static auto readStringValue(Cursor<Char, Dialect>& cursor, JsonArenaBuilder& builder) -> void;
+		template <class Char, class Dialect>
+		static auto readStringValue(Cursor<Char, Dialect>& cursor, Validator& validator) -> void;
+
+		// read the parts of a value that are under `node`
+		template <class Char, class Dialect>
+		auto readSelectedValue(Cursor<Char, Dialect>& cursor, Selection& selection,
+							   int node, int depth) const -> void;
+
+		// read the selected elements of an array from the cursor
+		template <class Char, class Dialect>
+		auto readSelectedArray(Cursor<Char, Dialect>& cursor, Selection& selection,
+							   int node, int depth) const -> void;
+
+		// read the selected members of an object from the cursor
+		template <class Char, class Dialect>
+		auto readSelectedObject(Cursor<Char, Dialect>& cursor, Selection& selection,
+								int node, int depth) const -> void;
+
+		// read a value starting at the current token
+		template <class Char, class Handler>
+		auto readIndexedValue(IndexCursor<Char>& cursor, Handler& handler) const -> void;
+
+		// read a string, number, or literal starting at the current token
+		template <class Char, class Handler>
+		auto readIndexedScalar(IndexCursor<Char>& cursor, Handler& handler) const -> void;
+
+		// read an object key and the colon after it
+		template <class Char, class Handler>
+		auto readIndexedMember(IndexCursor<Char>& cursor, Handler& handler) const -> void;
+
+		// read a string starting at the current token
+		template <class Char>
+		auto readIndexedString(IndexCursor<Char>& cursor) const -> QString;
+
+		// read a string value starting at the current token and hand
+		// it on, the same way as readStringValue()
+		template <class Char, class Handler>
+		auto readIndexedStringValue(IndexCursor<Char>& cursor, Handler& handler) const -> void;
+		template <class Char>
+		auto readIndexedStringValue(IndexCursor<Char>& cursor, TreeBuilder& builder) const -> void;
+		template <class Char>
+		auto readIndexedStringValue(IndexCursor<Char>& cursor, JsonArenaBuilder& builder) const -> void;
+
+		// read an object key starting at the current token
+		template <class Char>
+		auto readIndexedKey(IndexCursor<Char>& cursor) const -> QString;
+
+		// TODO read comments?
+};
+
+#endif // JSON_READER_P_H
@@ -0,0 +1,623 @@
+// header file
+#include <JsonDataTree/JsonStreamReader.h>
+
+// internal data
+#include <QSharedData>
+#include <QString>
+#include <QVector>
+#include <QQueue>
+
+// the tokens themselves
+#include "JsonLexer_p.h"
+
+// what the tokens are turned into
+#include "JsonTreeBuilder_p.h"
+
+// private data class
+class JSON::JsonStreamReaderPrivate : public QSharedData {
+	public:
+		// what the grammar allows next
+		enum Expect {
+			Value,
+			ValueOrEnd,         // right after [
+			ValueAfterComma,    // in an array
+			Key,                // right after a comma in an object
+			KeyOrEnd,           // right after {
+			Colon,
+			CommaOrEnd
+		};
+
+		// what the lexer is in the middle of
+		enum Lexing {
+			Between,            // not in the middle of anything
+			String,
+			Escape,             // right after a \ in a string
+			Unicode,            // in the four hex digits of a \u
+			Number,
+			Literal,
+			Slash,              // a / that may start a comment
+			LineComment,
+			BlockComment,
+			BlockCommentStar,   // a * that may end a block comment
+			Space               // a UTF-8 sequence that may be white space
+		};
+
+		// an array or object that has been started but not ended
+		struct Container {
+			bool isObject;
+			int start;
+		};
+
+		JsonStreamReaderPrivate()
+			:	maxDepth(JsonReader::DefaultMaxDepth) {
+			reset();
+		}
+
+		// how deeply arrays and objects can be nested, or 0
+		int maxDepth;
+
+		// everything read before the current chunk
+		int consumed;
+		bool failed;
+		JsonReaderErrors errors;
+
+		Expect expect;
+		Lexing lexing;
+		QVector<Container> open;
+		JsonTreeBuilder builder;
+		QQueue<JsonValue> values;
+		// the keys seen so far, in every value
+		JsonKeyCache keys;
+
+		// where the current token, comment, or sequence started
+		int tokenStart;
+		// the current string, and the bytes not decoded yet
+		QString string;
+		QByteArray raw;
+		bool isKey;
+		// the current \u escape
+		int hexStart;
+		int hexDigits;
+		int hexNumber;
+		// the current number, literal, or UTF-8 sequence
+		QByteArray text;
+		const char* literal;
+		int needed;
+
+		// start over on a new stream
+		auto reset() -> void;
+
+		// read a chunk
+		auto feed(const uchar* data, int length) -> void;
+
+		// handle one character, or the end of the stream (-1)
+		auto step(int c, int at) -> void;
+
+		// handle a character that is not part of a token
+		auto between(int c, int at) -> void;
+
+		// handle the first character of a token
+		auto token(int c, int at) -> void;
+
+		// handle the first character of a value
+		auto startValue(int c, int at) -> void;
+
+		// handle a character in a string
+		auto stringStep(int c, int at) -> void;
+
+		// the number ended right before c
+		auto endNumber(int c, int at) -> void;
+
+		// the UTF-8 sequence in text has ended
+		auto endSpace() -> void;
+
+		// close the innermost array or object
+		auto endContainer() -> void;
+
+		// a whole value has been read
+		auto endValue() -> void;
+
+		// record an error; parsing stops at the first one
+		auto error(JsonReaderError::ErrorType type, int at) -> void;
+
+		// check that there is nothing but ASCII in `bytes`
+		static auto isAscii(const QByteArray& bytes) -> bool;
+};
+
+using namespace JSON;
+
+JsonStreamReader::JsonStreamReader()
+	:	d(new JsonStreamReaderPrivate) { }
+
+JsonStreamReader::JsonStreamReader(const JsonStreamReader& other)
+	:	d(other.d) { }
+
+JsonStreamReader::~JsonStreamReader() { }
+
+auto JsonStreamReader::operator= (const JsonStreamReader& other) -> JsonStreamReader& {
+	if (this == &other) return *this;
+	d = other.d;
+	return *this;
+}
+
+auto JsonStreamReader::feed(QByteArray chunk) -> bool {
+	if (!d->failed) {
+		d->feed(reinterpret_cast<const uchar*>(chunk.constData()), chunk.size());
+	}
+	return !d->failed;
+}
+
+auto JsonStreamReader::finish() -> bool {
+	if (!d->failed) {
+		d->step(-1, d->consumed);
+	}
+	bool ans = !d->failed;
+	// keep what has been read, and the errors
+	QQueue<JsonValue> values = d->values;
+	JsonReaderErrors errors = d->errors;
+	d->reset();
+	d->values = values;
+	d->errors = errors;
+	return ans;
+}
+
+auto JsonStreamReader::hasValue() const -> bool {
+	return !d->values.isEmpty();
+}
+
+auto JsonStreamReader::takeValue() -> JsonValue {
+	if (d->values.isEmpty()) {
+		return JsonValue::Null;
+	}
+	return d->values.dequeue();
+}
+
+auto JsonStreamReader::errors() const -> JsonReaderErrors {
+	return d->errors;
+}
+
+auto JsonStreamReader::reset() -> void {
+	d->reset();
+}
+
+auto JsonStreamReader::getMaxDepth() const -> int {
+	return qMax(0, d->maxDepth);
+}
+
+auto JsonStreamReader::setMaxDepth(int depth) -> void {
+	d->maxDepth = depth;
+}
+
+auto JsonStreamReaderPrivate::reset() -> void {
+	consumed = 0;
+	failed = false;
+	errors = JsonReaderErrors();
+	expect = Value;
+	lexing = Between;
+	open.clear();
+	builder.clear();
+	values.clear();
+	tokenStart = 0;
+	string.clear();
+	raw.clear();
+	isKey = false;
+	hexStart = 0;
+	hexDigits = 0;
+	hexNumber = 0;
+	text.clear();
+	literal = nullptr;
+	needed = 0;
+}
+
+auto JsonStreamReaderPrivate::feed(const uchar* data, int length) -> void {
+	int i = 0;
+	while (i < length && !failed) {
+		if (lexing == String) {
+			// copy runs of plain characters in one go
+			int run = i;
+			while (i < length && data[i] != '\"' && data[i] != '\\') {
+				++ i;
+			}
+			raw.append(reinterpret_cast<const char*>(data + run), i - run);
+			if (i == length) {
+				break;
+			}
+		}
+		step(data[i], consumed + i);
+		++ i;
+	}
+	consumed += length;
+}
+
+auto JsonStreamReaderPrivate::step(int c, int at) -> void {
+	switch (lexing) {
+		case Between:
+			between(c, at);
+			break;
+		case String:
+		case Escape:
+		case Unicode:
+			stringStep(c, at);
+			break;
+		case Number:
+			switch (c) {
+				case '0': case '1': case '2':
+				case '3': case '4': case '5':
+				case '6': case '7': case '8':
+				case '9': case '-': case '+':
+				case '.': case 'e': case 'E':
+					text.append(char(c));
+					break;
+				default:
+					endNumber(c, at);
+					break;
+			}
+			break;
+		case Literal:
+			if (c != literal[text.size()]) {
+				error(JsonReaderError::UnknownLiteral, tokenStart + 1);
+				break;
+			}
+			text.append(char(c));
+			if (!literal[text.size()]) {
+				lexing = Between;
+				switch (*literal) {
+					case 't':
+						builder.boolean(true);
+						break;
+					case 'f':
+						builder.boolean(false);
+						break;
+					default:
+						builder.null();
+						break;
+				}
+				endValue();
+			}
+			break;
+		case Slash:
+			if (c == '/') {
+				lexing = LineComment;
+			} else if (c == '*') {
+				lexing = BlockComment;
+			} else {
+				// not a comment after all
+				lexing = Between;
+				token('/', tokenStart);
+			}
+			break;
+		case LineComment:
+			if (c == '\n' || c < 0) {
+				lexing = Between;
+				between(c, at);
+			}
+			break;
+		case BlockComment:
+		case BlockCommentStar:
+			if (c < 0) {
+				error(JsonReaderError::CommentWithNoEnd, tokenStart);
+			} else if (lexing == BlockCommentStar && c == '/') {
+				lexing = Between;
+			} else {
+				lexing = c == '*' ? BlockCommentStar : BlockComment;
+			}
+			break;
+		case Space:
+			if (c >= 0 && (c & 0xc0) == 0x80) {
+				text.append(char(c));
+				if (text.size() == needed) {
+					endSpace();
+				}
+			} else {
+				// the sequence was cut short
+				endSpace();
+				if (!failed) {
+					step(c, at);
+				}
+			}
+			break;
+	}
+}
+
+auto JsonStreamReaderPrivate::between(int c, int at) -> void {
+	switch (c) {
+		case ' ': case '\t': case '\n': case '\r':
+		case '\v': case '\f':
+			return;
+		case '/':
+			lexing = Slash;
+			tokenStart = at;
+			return;
+		default:
+			break;
+	}
+	if (c >= 0xc0) {
+		// might be non-ASCII white space; wait for the rest of it
+		lexing = Space;
+		tokenStart = at;
+		text = QByteArray(1, char(c));
+		needed = (c & 0xe0) == 0xc0 ? 2 : (c & 0xf0) == 0xe0 ? 3 : 4;
+		return;
+	}
+	token(c, at);
+}
+
+auto JsonStreamReaderPrivate::token(int c, int at) -> void {
+	switch (expect) {
+		case ValueOrEnd:
+			if (c == ']') {
+				endContainer();
+				return;
+			}
+			startValue(c, at);
+			return;
+		case ValueAfterComma:
+			if (c == ']') {
+				// , and ] can't happen next to each other
+				error(JsonReaderError::ArrayWithExtraComma, at + 1);
+				return;
+			}
+			startValue(c, at);
+			return;
+		case Value:
+			if (c < 0 && open.isEmpty()) {
+				// the stream ended between values
+				return;
+			}
+			startValue(c, at);
+			return;
+		case KeyOrEnd:
+		case Key:
+			if (c == '}') {
+				if (expect == Key) {
+					// , and } can't happen next to each other
+					error(JsonReaderError::ObjectWithExtraComma, at + 1);
+				} else {
+					endContainer();
+				}
+				return;
+			}
+			if (c != '\"') {
+				// has to be a string
+				error(JsonReaderError::ObjectWithNonStringKey, at + 1);
+				return;
+			}
+			lexing = String;
+			tokenStart = at;
+			isKey = true;
+			return;
+		case Colon:
+			if (c != ':') {
+				error(JsonReaderError::ObjectWithMissingColon, at + 1);
+				return;
+			}
+			expect = Value;
+			return;
+		case CommaOrEnd: {
+			const Container& container = open.last();
+			if (c == ',') {
+				expect = container.isObject ? Key : ValueAfterComma;
+			} else if (c == (container.isObject ? '}' : ']')) {
+				endContainer();
+			} else {
+				// wasn't a separator, so we had to be done
+				error(container.isObject
+						? JsonReaderError::ObjectWithNoClosingBrace
+						: JsonReaderError::ArrayWithNoClosingBracket,
+					  container.start);
+			}
+			return;
+		}
+	}
+}
+
+auto JsonStreamReaderPrivate::startValue(int c, int at) -> void {
+	tokenStart = at;
+	if ((c == '{' || c == '[') && maxDepth > 0 && open.size() >= maxDepth) {
+		error(JsonReaderError::NestingTooDeep, at);
+		return;
+	}
+	switch (c) {
+		case '{': // object
+			builder.startObject();
+			open.append(Container { true, at });
+			expect = KeyOrEnd;
+			return;
+		case '[': // array
+			builder.startArray();
+			open.append(Container { false, at });
+			expect = ValueOrEnd;
+			return;
+		case '\"': // string
+			lexing = String;
+			isKey = false;
+			return;
+		case '0': case '1': case '2':
+		case '3': case '4': case '5':
+		case '6': case '7': case '8':
+		case '9': case '-': // numbers
+			lexing = Number;
+			text = QByteArray(1, char(c));
+			return;
+		case 'f': // false
+			literal = "false";
+			break;
+		case 't': // true
+			literal = "true";
+			break;
+		case 'n': // null
+			literal = "null";
+			break;
+		default: // unrecognizable
+			// the offset is one past the start, as it always has been
+			error(JsonReaderError::UnknownLiteral, at + 1);
+			return;
+	}
+	lexing = Literal;
+	text = QByteArray(1, char(c));
+}
+
+auto JsonStreamReaderPrivate::stringStep(int c, int at) -> void {
+	if (c < 0) {
+		if (lexing == Unicode) {
+			error(JsonReaderError::StringWithBadHex, hexStart);
+		} else {
+			// we didn't reach the end of the string
+			error(JsonReaderError::StringWithNoClosingQuote, tokenStart);
+		}
+		return;
+	}
+	if (lexing == Unicode) {
+		int digit = hexValue(ushort(c));
+		if (digit < 0) {
+			error(JsonReaderError::StringWithBadHex, hexStart);
+			return;
+		}
+		hexNumber = (hexNumber << 4) | digit;
+		if (++ hexDigits == 4) {
+			// output the corresponding char
+			string.append(QChar(ushort(hexNumber)));
+			lexing = String;
+		}
+		return;
+	}
+	if (lexing == Escape) {
+		lexing = String;
+		switch (c) {
+			case '\"': // double quote
+				string.append(QChar('\"'));
+				break;
+			case '\\': // backslash
+				string.append(QChar('\\'));
+				break;
+			case '/': // forward slash
+				string.append(QChar('/'));
+				break;
+			case 'b': // backspace
+				string.append(QChar('\b'));
+				break;
+			case 'f': // formfeed
+				string.append(QChar('\f'));
+				break;
+			case 'n': // newline
+				string.append(QChar('\n'));
+				break;
+			case 'r': // linefeed
+				string.append(QChar('\r'));
+				break;
+			case 't': // tab
+				string.append(QChar('\t'));
+				break;
+			case 'u': // 4-letter unicode hex
+				lexing = Unicode;
+				hexStart = at + 1;
+				hexDigits = 0;
+				hexNumber = 0;
+				break;
+			default:
+				error(JsonReaderError::StringWithBadEscape, at - 1);
+				break;
+		}
+		return;
+	}
+	if (c == '\\') {
+		// flush the plain characters before the escape
+		string.append(QString::fromUtf8(raw));
+		raw.clear();
+		lexing = Escape;
+		return;
+	}
+	if (c != '\"') {
+		raw.append(char(c));
+		return;
+	}
+	// the closing quote
+	if (isKey && string.isEmpty() && isAscii(raw)) {
+		string = keys.key(reinterpret_cast<const uchar*>(raw.constData()), raw.size());
+	} else if (string.isEmpty()) {
+		string = QString::fromUtf8(raw);
+	} else {
+		string.append(QString::fromUtf8(raw));
+	}
+	raw.clear();
+	lexing = Between;
+	if (isKey) {
+		builder.key(string);
+		expect = Colon;
+	} else {
+		builder.string(string);
+		endValue();
+	}
+	string.clear();
+}
+
+auto JsonStreamReaderPrivate::endNumber(int c, int at) -> void {
+	// the number is checked with the same code as JsonReader uses;
+	// it stops at the first character that does not fit
+	JsonCursor<uchar> cursor(reinterpret_cast<const uchar*>(text.constData()),
+							 text.size(), nullptr);
+	JsonNumber number = JsonLexer::readNumber(cursor);
+	if (cursor.failed) {
+		error(JsonReaderError::NumberWithBadCharacter, tokenStart);
+		return;
+	}
+	lexing = Between;
+	number.handle(builder);
+	endValue();
+
+	// whatever did not fit comes after the number
+	QByteArray rest = text.mid(cursor.offset());
+	int restStart = tokenStart + cursor.offset();
+	for (int i = 0; i < rest.size() && !failed; ++ i) {
+		step(uchar(rest[i]), restStart + i);
+	}
+	if (!failed) {
+		step(c, at);
+	}
+}
+
+auto JsonStreamReaderPrivate::endSpace() -> void {
+	const uchar* sequence = reinterpret_cast<const uchar*>(text.constData());
+	bool space = unicodeSpace(sequence, sequence + text.size()) > 0
+		// a byte order mark at the very start is skipped, too
+		|| (tokenStart == 0 && text == "\xef\xbb\xbf");
+	lexing = Between;
+	if (!space) {
+		// it starts something that isn't allowed
+		token(sequence[0], tokenStart);
+	}
+}
+
+auto JsonStreamReaderPrivate::endContainer() -> void {
+	if (open.last().isObject) {
+		builder.endObject();
+	} else {
+		builder.endArray();
+	}
+	open.removeLast();
+	endValue();
+}
+
+auto JsonStreamReaderPrivate::endValue() -> void {
+	if (open.isEmpty()) {
+		values.enqueue(builder.result());
+		builder.clear();
+		expect = Value;
+	} else {
+		expect = CommaOrEnd;
+	}
+}
+
+auto JsonStreamReaderPrivate::error(JsonReaderError::ErrorType type, int at) -> void {
+	failed = true;
+	errors.addError(type, at);
+}
+
+auto JsonStreamReaderPrivate::isAscii(const QByteArray& bytes) -> bool {
+	for (char c : bytes) {
+		if (uchar(c) >= 0x80) {
+			return false;
+		}
+	}
+	return true;
+}
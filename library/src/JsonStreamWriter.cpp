@@ -0,0 +1,326 @@
+// header file
+#include <JsonDataTree/JsonStreamWriter.h>
+
+// internal data
+#include <QVector>
+
+// the layout and escaping, shared with JsonWriter
+#include "JsonWriter_p.h"
+
+// for compressed output
+#include "JsonCompression_p.h"
+
+// for writing numbers
+#include "JsonNumberFormat_p.h"
+
+using namespace JSON;
+
+// private data class
+class JSON::JsonStreamWriterPrivate {
+	public:
+		typedef JsonWriterPrivate::Utf8Output Utf8Output;
+
+		// an array or object that has been begun but not ended
+		struct Container {
+			bool isObject;
+			bool isEmpty;
+		};
+
+		JsonStreamWriterPrivate()
+			:	io(nullptr), compression(JsonWriter::NoCompression),
+				hasKey(false), hasValue(false) { }
+
+		// the options, and what the text is written with
+		JsonWriterPrivate writer;
+		QIODevice* io;
+		JsonWriter::Compression compression;
+		// where the text goes; set up once the first of it is written
+		QScopedPointer<JsonDeflateDevice> deflated;
+		QScopedPointer<Utf8Output> out;
+		QVector<Container> open;
+		// the innermost object has a key waiting for its value
+		bool hasKey;
+		// a value at the top level has been written
+		bool hasValue;
+
+		// get the output, setting it up if need be
+		auto output() -> Utf8Output&;
+
+		// write what goes before a value; false if one can't go here
+		auto startValue() -> bool;
+
+		// note that a value has been written
+		auto endValue() -> void {
+			if (open.isEmpty()) {
+				hasValue = true;
+			}
+		}
+
+		// write the comma and line break before the next value or key
+		// in the innermost array or object
+		auto writeSeparator() -> void;
+
+		// close the innermost array or object
+		auto close() -> void;
+};
+
+auto JsonStreamWriterPrivate::output() -> Utf8Output& {
+	if (!out) {
+		if (compression != JsonWriter::NoCompression) {
+			// the text is compressed on another thread as it is written
+			deflated.reset(new JsonDeflateDevice(io,
+				compression == JsonWriter::GzipCompression));
+			out.reset(new Utf8Output(deflated.data()));
+		} else {
+			out.reset(new Utf8Output(io));
+		}
+	}
+	return *out;
+}
+
+auto JsonStreamWriterPrivate::startValue() -> bool {
+	if (!io) {
+		return false;
+	}
+	if (open.isEmpty()) {
+		// each value at the top level after the first
+		// goes on a line of its own
+		if (hasValue) {
+			output().write('\n');
+		}
+		return true;
+	}
+	if (open.last().isObject) {
+		// the key has written everything before the value
+		if (!hasKey) {
+			return false;
+		}
+		hasKey = false;
+		return true;
+	}
+	writeSeparator();
+	return true;
+}
+
+auto JsonStreamWriterPrivate::writeSeparator() -> void {
+	Utf8Output& text = output();
+	Container& container = open.last();
+	if (!container.isEmpty) {
+		text.write(',');
+	}
+	container.isEmpty = false;
+	if (writer.format != JsonWriter::CompactFormat) {
+		writer.writeLineBreak(text, open.size());
+	}
+}
+
+auto JsonStreamWriterPrivate::close() -> void {
+	Utf8Output& text = output();
+	Container container = open.takeLast();
+	// if its empty, one-line [] or {} works
+	if (!container.isEmpty && writer.format != JsonWriter::CompactFormat) {
+		writer.writeLineBreak(text, open.size());
+	}
+	text.write(container.isObject ? '}' : ']');
+	endValue();
+}
+
+JsonStreamWriter::JsonStreamWriter()
+	:	d(new JsonStreamWriterPrivate) { }
+
+JsonStreamWriter::JsonStreamWriter(QIODevice* io)
+	:	d(new JsonStreamWriterPrivate) {
+	d->io = io;
+}
+
+JsonStreamWriter::~JsonStreamWriter() {
+	finish();
+}
+
+auto JsonStreamWriter::getDevice() const -> QIODevice* {
+	return d->io;
+}
+
+auto JsonStreamWriter::setDevice(QIODevice* io) -> void {
+	finish();
+	d->io = io;
+}
+
+auto JsonStreamWriter::getCompression() const -> JsonWriter::Compression {
+	return d->compression;
+}
+
+auto JsonStreamWriter::setCompression(JsonWriter::Compression compression) -> void {
+	d->compression = compression;
+}
+
+auto JsonStreamWriter::getFormat() const -> JsonWriter::Format {
+	return d->writer.format;
+}
+
+auto JsonStreamWriter::setFormat(JsonWriter::Format format) -> void {
+	d->writer.format = format;
+}
+
+auto JsonStreamWriter::getIndentation() const -> int {
+	return d->writer.indentation;
+}
+
+auto JsonStreamWriter::setIndentation(int spaces) -> void {
+	d->writer.indentation = qMax(spaces, 0);
+	d->writer.setUpIndent();
+}
+
+auto JsonStreamWriter::getLineWidth() const -> int {
+	return d->writer.lineWidth;
+}
+
+auto JsonStreamWriter::setLineWidth(int width) -> void {
+	d->writer.lineWidth = qMax(width, 0);
+}
+
+auto JsonStreamWriter::beginArray() -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->output().write('[');
+	d->open.append({false, true});
+	return true;
+}
+
+auto JsonStreamWriter::endArray() -> bool {
+	if (d->open.isEmpty() || d->open.last().isObject) {
+		return false;
+	}
+	d->close();
+	return true;
+}
+
+auto JsonStreamWriter::beginObject() -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->output().write('{');
+	d->open.append({true, true});
+	return true;
+}
+
+auto JsonStreamWriter::endObject() -> bool {
+	if (d->open.isEmpty() || !d->open.last().isObject || d->hasKey) {
+		return false;
+	}
+	d->close();
+	return true;
+}
+
+auto JsonStreamWriter::key(const QString& key) -> bool {
+	if (d->open.isEmpty() || !d->open.last().isObject || d->hasKey) {
+		return false;
+	}
+	d->writeSeparator();
+	JsonStreamWriterPrivate::Utf8Output& text = d->output();
+	d->writer.writeString(text, key);
+	if (d->writer.format == JsonWriter::CompactFormat) {
+		text.write(':');
+	} else {
+		text.write(": ");
+	}
+	d->hasKey = true;
+	return true;
+}
+
+auto JsonStreamWriter::value(const JsonValue& value) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	// it is as deep as the arrays and objects it is in
+	d->writer.writeValue(d->output(), value, d->open.size(), nullptr);
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::value(const QString& string) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->writer.writeString(d->output(), string);
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::value(const char* string) -> bool {
+	return value(QString::fromUtf8(string));
+}
+
+auto JsonStreamWriter::value(double number) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->writer.writeNumber(d->output(), number);
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::value(qint64 number) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	char text[JsonNumberFormat::maxLength];
+	d->output().write(text, JsonNumberFormat::formatInteger(number, text));
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::value(quint64 number) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	char text[JsonNumberFormat::maxLength];
+	d->output().write(text, JsonNumberFormat::formatInteger(number, text));
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::value(bool boolean) -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->writer.writeBoolean(d->output(), boolean);
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::nullValue() -> bool {
+	if (!d->startValue()) {
+		return false;
+	}
+	d->writer.writeNull(d->output());
+	d->endValue();
+	return true;
+}
+
+auto JsonStreamWriter::depth() const -> int {
+	return d->open.size();
+}
+
+auto JsonStreamWriter::flush() -> void {
+	if (d->out) {
+		d->out->flush();
+	}
+}
+
+auto JsonStreamWriter::finish() -> bool {
+	bool complete = d->open.isEmpty();
+	if (d->out) {
+		d->out->flush();
+		d->out.reset();
+	}
+	if (d->deflated) {
+		d->deflated->close();
+		d->deflated.reset();
+	}
+	d->open.clear();
+	d->hasKey = false;
+	d->hasValue = false;
+	return complete;
+}
@@ -0,0 +1,693 @@
+// header file
+#include "JsonStructuralIndex_p.h"
+
+// for the last block
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#	define JSON_X86_SIMD
+#	include <immintrin.h>
+#endif
+
+using namespace JSON;
+
+// what one 64-character block contains, one bit per character
+struct JsonBlockMasks {
+	quint64 structural; // { } [ ] : ,
+	quint64 quote;
+	quint64 backslash;
+	quint64 space;      // the four JSON white space characters
+	quint64 slash;
+};
+
+// the state carried from one block to the next
+struct JsonBlockCarry {
+	quint64 escaped;    // the first character of the block is escaped
+	quint64 inString;   // all ones if the block starts inside a string
+	quint64 scalar;     // the last block ended in the middle of a token
+};
+
+static inline auto countTrailingZeros(quint64 bits) -> int {
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	int n = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		++ n;
+	}
+	return n;
+#endif
+}
+
+// bit i is set if an odd number of bits at or below i are set
+static inline auto prefixXor(quint64 bits) -> quint64 {
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+// find the characters escaped by a backslash; only the last
+// backslash of an odd-length run escapes anything
+static inline auto findEscaped(quint64 backslash, quint64& carry) -> quint64 {
+	const quint64 evenBits = Q_UINT64_C(0x5555555555555555);
+	backslash &= ~carry;
+	quint64 followsEscape = (backslash << 1) | carry;
+	quint64 oddStarts = backslash & ~evenBits & ~followsEscape;
+	quint64 evenStarts = oddStarts + backslash;
+	carry = evenStarts < oddStarts ? 1 : 0;
+	quint64 invert = evenStarts << 1;
+	return (evenBits ^ invert) & followsEscape;
+}
+
+template <class Char>
+static auto classifyScalar(const Char* p, JsonBlockMasks& m) -> void {
+	m.structural = m.quote = m.backslash = m.space = m.slash = 0;
+	for (int i = 0; i < 64; ++ i) {
+		quint64 bit = quint64(1) << i;
+		switch (p[i]) {
+			case '{': case '}':
+			case '[': case ']':
+			case ':': case ',':
+				m.structural |= bit;
+				break;
+			case '\"':
+				m.quote |= bit;
+				break;
+			case '\\':
+				m.backslash |= bit;
+				break;
+			case ' ': case '\t':
+			case '\n': case '\r':
+				m.space |= bit;
+				break;
+			case '/':
+				m.slash |= bit;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+#ifdef JSON_X86_SIMD
+
+// Both kernels work on bytes. UTF-8 is loaded as it is; UTF-16 code
+// units are narrowed with unsigned saturation first, so anything outside
+// of Latin-1 becomes 0x00 or 0xff, neither of which is interesting to
+// the scanner.
+
+__attribute__((target("sse4.2")))
+static inline auto loadSse(const ushort* p) -> __m128i {
+	const __m128i* in = reinterpret_cast<const __m128i*>(p);
+	return _mm_packus_epi16(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+}
+
+__attribute__((target("sse4.2")))
+static inline auto loadSse(const uchar* p) -> __m128i {
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+__attribute__((target("sse4.2")))
+static inline auto maskSse(__m128i a, __m128i b, __m128i c, __m128i d) -> quint64 {
+	return quint64(quint16(_mm_movemask_epi8(a)))
+		| (quint64(quint16(_mm_movemask_epi8(b))) << 16)
+		| (quint64(quint16(_mm_movemask_epi8(c))) << 32)
+		| (quint64(quint16(_mm_movemask_epi8(d))) << 48);
+}
+
+__attribute__((target("sse4.2")))
+static inline auto equalSse(const __m128i* bytes, char c) -> quint64 {
+	__m128i v = _mm_set1_epi8(c);
+	return maskSse(_mm_cmpeq_epi8(bytes[0], v), _mm_cmpeq_epi8(bytes[1], v),
+				   _mm_cmpeq_epi8(bytes[2], v), _mm_cmpeq_epi8(bytes[3], v));
+}
+
+// one PCMPESTRM matches a 16-byte chunk against a whole character set
+#define JSON_SSE_ANY(set, n, chunk) \
+	_mm_cmpestrm(set, n, chunk, 16, \
+				 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_UNIT_MASK)
+
+template <class Char>
+__attribute__((target("sse4.2")))
+static auto classifySse42(const Char* p, JsonBlockMasks& m) -> void {
+	__m128i bytes[4] = {
+		loadSse(p), loadSse(p + 16), loadSse(p + 32), loadSse(p + 48)
+	};
+	const __m128i structural = _mm_setr_epi8('{', '}', '[', ']', ':', ',',
+											 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i space = _mm_setr_epi8(' ', '\t', '\n', '\r',
+										0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	m.structural = maskSse(JSON_SSE_ANY(structural, 6, bytes[0]),
+						   JSON_SSE_ANY(structural, 6, bytes[1]),
+						   JSON_SSE_ANY(structural, 6, bytes[2]),
+						   JSON_SSE_ANY(structural, 6, bytes[3]));
+	m.space = maskSse(JSON_SSE_ANY(space, 4, bytes[0]),
+					  JSON_SSE_ANY(space, 4, bytes[1]),
+					  JSON_SSE_ANY(space, 4, bytes[2]),
+					  JSON_SSE_ANY(space, 4, bytes[3]));
+	m.quote = equalSse(bytes, '\"');
+	m.backslash = equalSse(bytes, '\\');
+	m.slash = equalSse(bytes, '/');
+}
+
+#undef JSON_SSE_ANY
+
+__attribute__((target("avx2")))
+static inline auto loadAvx2(const ushort* p) -> __m256i {
+	const __m256i* in = reinterpret_cast<const __m256i*>(p);
+	// packus works per 128-bit lane, so put the quadwords back in order
+	return _mm256_permute4x64_epi64(
+		_mm256_packus_epi16(_mm256_loadu_si256(in), _mm256_loadu_si256(in + 1)),
+		0xd8);
+}
+
+__attribute__((target("avx2")))
+static inline auto loadAvx2(const uchar* p) -> __m256i {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("avx2")))
+static inline auto maskAvx2(__m256i lo, __m256i hi) -> quint64 {
+	return quint64(quint32(_mm256_movemask_epi8(lo)))
+		| (quint64(quint32(_mm256_movemask_epi8(hi))) << 32);
+}
+
+__attribute__((target("avx2")))
+static inline auto equalAvx2(__m256i lo, __m256i hi, char c) -> quint64 {
+	__m256i v = _mm256_set1_epi8(c);
+	return maskAvx2(_mm256_cmpeq_epi8(lo, v), _mm256_cmpeq_epi8(hi, v));
+}
+
+__attribute__((target("avx2")))
+static inline auto structuralAvx2(__m256i bytes) -> __m256i {
+	// '[' and ']' are '{' and '}' without the 0x20 bit
+	__m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+	return _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+						_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')),
+						_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','))));
+}
+
+__attribute__((target("avx2")))
+static inline auto spaceAvx2(__m256i bytes) -> __m256i {
+	return _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+						_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+						_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+}
+
+template <class Char>
+__attribute__((target("avx2")))
+static auto classifyAvx2(const Char* p, JsonBlockMasks& m) -> void {
+	__m256i lo = loadAvx2(p);
+	__m256i hi = loadAvx2(p + 32);
+	m.structural = maskAvx2(structuralAvx2(lo), structuralAvx2(hi));
+	m.space = maskAvx2(spaceAvx2(lo), spaceAvx2(hi));
+	m.quote = equalAvx2(lo, hi, '\"');
+	m.backslash = equalAvx2(lo, hi, '\\');
+	m.slash = equalAvx2(lo, hi, '/');
+}
+
+#endif // JSON_X86_SIMD
+
+auto JsonStructuralIndex::instructionSet() -> InstructionSet {
+#ifdef JSON_X86_SIMD
+	static const InstructionSet best = []() -> InstructionSet {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return Avx2;
+		}
+		if (__builtin_cpu_supports("sse4.2")) {
+			return Sse42;
+		}
+		return Scalar;
+	}();
+	return best;
+#else
+	return Scalar;
+#endif
+}
+
+template <class Char>
+static auto buildIndex(const Char* data, int length, QVector<int>& index,
+					   JsonStructuralIndex::InstructionSet set) -> bool {
+	auto classify = &classifyScalar<Char>;
+#ifdef JSON_X86_SIMD
+	if (set == JsonStructuralIndex::Avx2) {
+		classify = &classifyAvx2<Char>;
+	} else if (set == JsonStructuralIndex::Sse42) {
+		classify = &classifySse42<Char>;
+	}
+#else
+	Q_UNUSED(set)
+#endif
+
+	// most documents have a token every few characters; grow as needed
+	index.resize(qMax(64, length / 4));
+	int count = 0;
+
+	JsonBlockCarry carry = { 0, 0, 0 };
+	JsonBlockMasks m;
+	Char tail[64];
+	for (int base = 0; base < length; base += 64) {
+		if (length - base >= 64) {
+			classify(data + base, m);
+		} else {
+			// pad the last block with white space
+			int n = length - base;
+			for (int i = 0; i < 64; ++ i) {
+				tail[i] = i < n ? data[base + i] : Char(' ');
+			}
+			classify(tail, m);
+		}
+
+		// work out which quotes really start or end strings
+		quint64 escaped = findEscaped(m.backslash, carry.escaped);
+		quint64 quote = m.quote & ~escaped;
+		// this covers the opening quote and the inside of the string
+		quint64 inString = prefixXor(quote) ^ carry.inString;
+		carry.inString = quint64(qint64(inString) >> 63);
+
+		if (m.slash & ~inString) {
+			// comments are left to the regular reader
+			return false;
+		}
+
+		// everything else outside of strings starts or continues a token
+		quint64 scalar = ~(m.structural | m.space | quote | inString);
+		quint64 scalarStarts = scalar & ~((scalar << 1) | carry.scalar);
+		carry.scalar = scalar >> 63;
+
+		quint64 bits = (m.structural & ~inString) | quote | scalarStarts;
+		if (count + 64 > index.size()) {
+			index.resize(index.size() * 2);
+		}
+		int* out = index.data() + count;
+		while (bits) {
+			*out ++ = base + countTrailingZeros(bits);
+			bits &= bits - 1;
+		}
+		count = out - index.data();
+	}
+	index.resize(count);
+
+	// an unterminated string runs off the end
+	return !carry.inString;
+}
+
+auto JsonStructuralIndex::build(const ushort* data, int length,
+								QVector<int>& index,
+								InstructionSet set) -> bool {
+	return buildIndex(data, length, index, set);
+}
+
+auto JsonStructuralIndex::build(const uchar* data, int length,
+								QVector<int>& index,
+								InstructionSet set) -> bool {
+	return buildIndex(data, length, index, set);
+}
+
+// the first invalid sequence at or after `from`, one sequence at a
+// time; `from` has to be the start of a sequence
+static auto findInvalidUtf8Scalar(const uchar* data, int from, int length) -> int {
+	int i = from;
+	while (i < length) {
+		// ASCII eight bytes at a time
+		while (length - i >= 8) {
+			quint64 word;
+			std::memcpy(&word, data + i, 8);
+			if (word & Q_UINT64_C(0x8080808080808080)) {
+				break;
+			}
+			i += 8;
+		}
+		if (i >= length) {
+			break;
+		}
+		uint c = data[i];
+		if (c < 0x80) {
+			++ i;
+			continue;
+		}
+		// how many continuation bytes follow, and what the first of
+		// them can be so that the sequence is not overlong, not a
+		// surrogate, and not past U+10FFFF
+		int follow;
+		uint low = 0x80;
+		uint high = 0xbf;
+		if (c >= 0xc2 && c <= 0xdf) {
+			follow = 1;
+		} else if (c >= 0xe0 && c <= 0xef) {
+			follow = 2;
+			if (c == 0xe0) {
+				low = 0xa0;
+			} else if (c == 0xed) {
+				high = 0x9f;
+			}
+		} else if (c >= 0xf0 && c <= 0xf4) {
+			follow = 3;
+			if (c == 0xf0) {
+				low = 0x90;
+			} else if (c == 0xf4) {
+				high = 0x8f;
+			}
+		} else {
+			return i;
+		}
+		if (length - i <= follow || data[i + 1] < low || data[i + 1] > high) {
+			return i;
+		}
+		for (int k = 2; k <= follow; ++ k) {
+			if ((data[i + k] & 0xc0) != 0x80) {
+				return i;
+			}
+		}
+		i += follow + 1;
+	}
+	return -1;
+}
+
+// look at the block at `base` byte by byte, once the whole block
+// has been found to be invalid; everything before the last sequence
+// of the block before is known to be fine, and that sequence starts
+// at one of the three bytes before `base`, or else at `base` itself
+static auto findInvalidUtf8From(const uchar* data, int base, int length) -> int {
+	int from = qMax(0, base - 3);
+	while (from < base && (data[from] & 0xc0) == 0x80) {
+		++ from;
+	}
+	return findInvalidUtf8Scalar(data, from, length);
+}
+
+#ifdef JSON_X86_SIMD
+
+// The block kernels check every byte against the three before it with
+// three 16-entry lookups, on the high and low nibbles of the byte before
+// and the high nibble of the byte itself; each table entry is a set of
+// the mistakes that nibble allows, so a mistake is where all three agree.
+// Only sequences of three or four bytes need to look further back.
+
+enum JsonUtf8Error {
+	TooShort = 1 << 0,      // a lead byte without its continuation bytes
+	TooLong = 1 << 1,       // a continuation byte after ASCII
+	Overlong3 = 1 << 2,
+	TooLarge = 1 << 3,      // past U+10FFFF
+	Surrogate = 1 << 4,
+	Overlong2 = 1 << 5,
+	TooLarge1000 = 1 << 6,
+	Overlong4 = 1 << 6,
+	TwoContinuations = 1 << 7,
+	Carry = TooShort | TooLong | TwoContinuations
+};
+
+static const uchar byte1HighTable[16] = {
+	// 0_______ ________, ASCII
+	TooLong, TooLong, TooLong, TooLong,
+	TooLong, TooLong, TooLong, TooLong,
+	// 10______ ________, a continuation byte
+	TwoContinuations, TwoContinuations, TwoContinuations, TwoContinuations,
+	// 1100____ ________ and 1101____ ________, a two byte lead
+	TooShort | Overlong2,
+	TooShort,
+	// 1110____ ________, a three byte lead
+	TooShort | Overlong3 | Surrogate,
+	// 1111____ ________, a four byte lead
+	TooShort | TooLarge | TooLarge1000 | Overlong4
+};
+
+static const uchar byte1LowTable[16] = {
+	// ____0000 ________
+	Carry | Overlong3 | Overlong2 | Overlong4,
+	// ____0001 ________
+	Carry | Overlong2,
+	// ____001_ ________
+	Carry,
+	Carry,
+	// ____0100 ________
+	Carry | TooLarge,
+	// ____0101 ________ and ____011_ ________
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	// ____1___ ________
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000,
+	// ____1101 ________
+	Carry | TooLarge | TooLarge1000 | Surrogate,
+	Carry | TooLarge | TooLarge1000,
+	Carry | TooLarge | TooLarge1000
+};
+
+static const uchar byte2HighTable[16] = {
+	// ________ 0_______
+	TooShort, TooShort, TooShort, TooShort,
+	TooShort, TooShort, TooShort, TooShort,
+	// ________ 1000____
+	TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge1000 | Overlong4,
+	// ________ 1001____
+	TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge,
+	// ________ 101_____
+	TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+	TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+	// ________ 11______
+	TooShort, TooShort, TooShort, TooShort
+};
+
+__attribute__((target("sse4.2")))
+static inline auto highNibbleSse(__m128i v) -> __m128i {
+	return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+}
+
+// the mistakes in `input`, given the 16 bytes before it
+__attribute__((target("sse4.2")))
+static inline auto utf8ErrorsSse(__m128i input, __m128i previous) -> __m128i {
+	const __m128i byte1High = _mm_loadu_si128(reinterpret_cast<const __m128i*>(byte1HighTable));
+	const __m128i byte1Low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(byte1LowTable));
+	const __m128i byte2High = _mm_loadu_si128(reinterpret_cast<const __m128i*>(byte2HighTable));
+	__m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+	__m128i special = _mm_and_si128(
+		_mm_and_si128(_mm_shuffle_epi8(byte1High, highNibbleSse(prev1)),
+					  _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, _mm_set1_epi8(0x0f)))),
+		_mm_shuffle_epi8(byte2High, highNibbleSse(input)));
+	// the third and fourth bytes of a sequence have to be continuations
+	__m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+	__m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+	__m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80)));
+	__m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)));
+	__m128i must = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+	return _mm_xor_si128(must, special);
+}
+
+__attribute__((target("sse4.2")))
+static auto findInvalidUtf8Sse42(const uchar* data, int length) -> int {
+	__m128i previous = _mm_setzero_si128();
+	bool previousAscii = true;
+	uchar tail[64];
+	for (int base = 0; base < length; base += 64) {
+		const uchar* p = data + base;
+		if (length - base < 64) {
+			// pad the last block with white space
+			std::memset(tail, ' ', sizeof(tail));
+			std::memcpy(tail, p, size_t(length - base));
+			p = tail;
+		}
+		__m128i bytes[4] = {
+			loadSse(p), loadSse(p + 16), loadSse(p + 32), loadSse(p + 48)
+		};
+		__m128i any = _mm_or_si128(_mm_or_si128(bytes[0], bytes[1]),
+								   _mm_or_si128(bytes[2], bytes[3]));
+		bool ascii = !_mm_movemask_epi8(any);
+		// ASCII after ASCII can't be wrong
+		if (!ascii || !previousAscii) {
+			__m128i errors = _mm_or_si128(
+				_mm_or_si128(utf8ErrorsSse(bytes[0], previous),
+							 utf8ErrorsSse(bytes[1], bytes[0])),
+				_mm_or_si128(utf8ErrorsSse(bytes[2], bytes[1]),
+							 utf8ErrorsSse(bytes[3], bytes[2])));
+			if (!_mm_testz_si128(errors, errors)) {
+				return findInvalidUtf8From(data, base, length);
+			}
+		}
+		previous = bytes[3];
+		previousAscii = ascii;
+	}
+	// a sequence cut short by the end of a full last block
+	if (!previousAscii) {
+		__m128i errors = utf8ErrorsSse(_mm_set1_epi8(' '), previous);
+		if (!_mm_testz_si128(errors, errors)) {
+			return findInvalidUtf8From(data, length - length % 64 - 64, length);
+		}
+	}
+	return -1;
+}
+
+__attribute__((target("avx2")))
+static inline auto highNibbleAvx2(__m256i v) -> __m256i {
+	return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+}
+
+// the bytes `n` places before those of `input`, with `previous` before it
+#define JSON_AVX2_PREVIOUS(input, previous, n) \
+	_mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - (n))
+
+// the same as utf8ErrorsSse(), a lane at a time
+__attribute__((target("avx2")))
+static inline auto utf8ErrorsAvx2(__m256i input, __m256i previous) -> __m256i {
+	const __m256i byte1High = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(byte1HighTable)));
+	const __m256i byte1Low = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(byte1LowTable)));
+	const __m256i byte2High = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(byte2HighTable)));
+	__m256i prev1 = JSON_AVX2_PREVIOUS(input, previous, 1);
+	__m256i special = _mm256_and_si256(
+		_mm256_and_si256(_mm256_shuffle_epi8(byte1High, highNibbleAvx2(prev1)),
+						 _mm256_shuffle_epi8(byte1Low,
+											 _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+		_mm256_shuffle_epi8(byte2High, highNibbleAvx2(input)));
+	__m256i prev2 = JSON_AVX2_PREVIOUS(input, previous, 2);
+	__m256i prev3 = JSON_AVX2_PREVIOUS(input, previous, 3);
+	__m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xe0 - 0x80)));
+	__m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xf0 - 0x80)));
+	__m256i must = _mm256_and_si256(_mm256_or_si256(third, fourth),
+									_mm256_set1_epi8(char(0x80)));
+	return _mm256_xor_si256(must, special);
+}
+
+#undef JSON_AVX2_PREVIOUS
+
+__attribute__((target("avx2")))
+static auto findInvalidUtf8Avx2(const uchar* data, int length) -> int {
+	__m256i previous = _mm256_setzero_si256();
+	bool previousAscii = true;
+	uchar tail[64];
+	for (int base = 0; base < length; base += 64) {
+		const uchar* p = data + base;
+		if (length - base < 64) {
+			// pad the last block with white space
+			std::memset(tail, ' ', sizeof(tail));
+			std::memcpy(tail, p, size_t(length - base));
+			p = tail;
+		}
+		__m256i lo = loadAvx2(p);
+		__m256i hi = loadAvx2(p + 32);
+		bool ascii = !_mm256_movemask_epi8(_mm256_or_si256(lo, hi));
+		// ASCII after ASCII can't be wrong
+		if (!ascii || !previousAscii) {
+			__m256i errors = _mm256_or_si256(utf8ErrorsAvx2(lo, previous),
+											 utf8ErrorsAvx2(hi, lo));
+			if (!_mm256_testz_si256(errors, errors)) {
+				return findInvalidUtf8From(data, base, length);
+			}
+		}
+		previous = hi;
+		previousAscii = ascii;
+	}
+	// a sequence cut short by the end of a full last block
+	if (!previousAscii) {
+		__m256i errors = utf8ErrorsAvx2(_mm256_set1_epi8(' '), previous);
+		if (!_mm256_testz_si256(errors, errors)) {
+			return findInvalidUtf8From(data, length - length % 64 - 64, length);
+		}
+	}
+	return -1;
+}
+
+#endif // JSON_X86_SIMD
+
+auto JsonStructuralIndex::findInvalidUtf8(const uchar* data, int length,
+										  InstructionSet set) -> int {
+#ifdef JSON_X86_SIMD
+	if (set == Avx2) {
+		return findInvalidUtf8Avx2(data, length);
+	}
+	if (set == Sse42) {
+		return findInvalidUtf8Sse42(data, length);
+	}
+#else
+	Q_UNUSED(set)
+#endif
+	return findInvalidUtf8Scalar(data, 0, length);
+}
+
+// a character that can't be copied as it is
+static inline auto needsEscape(ushort c) -> bool {
+	return ushort(c - 0x20) >= 0x5f || c == '\"' || c == '\\';
+}
+
+static auto findEscapeScalar(const ushort* data, int from, int length) -> int {
+	while (from < length && !needsEscape(data[from])) {
+		++ from;
+	}
+	return from;
+}
+
+#ifdef JSON_X86_SIMD
+
+// Narrowed to bytes, anything past ASCII is 0x00 or at least 0x80, and
+// so is less than a space in a signed comparison.
+
+__attribute__((target("sse4.2")))
+static auto findEscapeSse42(const ushort* data, int from, int length) -> int {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i del = _mm_set1_epi8(0x7f);
+	for (; length - from >= 16; from += 16) {
+		__m128i bytes = loadSse(data + from);
+		__m128i escape = _mm_or_si128(
+			_mm_or_si128(_mm_cmplt_epi8(bytes, space), _mm_cmpeq_epi8(bytes, del)),
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)));
+		int mask = _mm_movemask_epi8(escape);
+		if (mask) {
+			return from + countTrailingZeros(quint64(mask));
+		}
+	}
+	return findEscapeScalar(data, from, length);
+}
+
+__attribute__((target("avx2")))
+static auto findEscapeAvx2(const ushort* data, int from, int length) -> int {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i quote = _mm256_set1_epi8('\"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i del = _mm256_set1_epi8(0x7f);
+	for (; length - from >= 32; from += 32) {
+		__m256i bytes = loadAvx2(data + from);
+		__m256i escape = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpgt_epi8(space, bytes), _mm256_cmpeq_epi8(bytes, del)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote), _mm256_cmpeq_epi8(bytes, backslash)));
+		quint32 mask = quint32(_mm256_movemask_epi8(escape));
+		if (mask) {
+			return from + countTrailingZeros(mask);
+		}
+	}
+	return findEscapeSse42(data, from, length);
+}
+
+#endif // JSON_X86_SIMD
+
+auto JsonStructuralIndex::findEscape(const ushort* data, int from, int length,
+									 InstructionSet set) -> int {
+#ifdef JSON_X86_SIMD
+	if (set == Avx2) {
+		return findEscapeAvx2(data, from, length);
+	}
+	if (set == Sse42) {
+		return findEscapeSse42(data, from, length);
+	}
+#else
+	Q_UNUSED(set)
+#endif
+	return findEscapeScalar(data, from, length);
+}
@@ -0,0 +1,71 @@
+#ifndef JSON_STRUCTURAL_INDEX_P_H
+#define JSON_STRUCTURAL_INDEX_P_H
+
+// for the data types
+#include <QtGlobal>
+#include <QVector>
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// the first stage of the structural index reader: scans the text 64
+// characters at a time with SIMD instructions, and records where
+// every token starts, so that the second stage can jump from token
+// to token instead of looking at every character; it also checks
+// UTF-8 for JsonReader::validate() the same way
+class JsonStructuralIndex {
+	public:
+		// the instruction sets the scanner can use
+		enum InstructionSet {
+			Scalar = 0,
+			Sse42,
+			Avx2
+		};
+
+		// the best one this CPU supports, checked with CPUID
+		// once and then cached; build() uses it by default
+		static auto instructionSet() -> InstructionSet;
+
+		// the offsets, in order, of every {, }, [, ], : and , outside
+		// of strings, of both quotes of every string, and of the first
+		// character of every other token (numbers and literals). This
+		// is false if a string is never closed, or if there is a /
+		// outside of a string, since the second stage can handle
+		// neither; the caller falls back to the usual reader then.
+		// `set` has to be one this CPU supports
+		static auto build(const ushort* data, int length,
+						  QVector<int>& index,
+						  InstructionSet set = instructionSet()) -> bool;
+
+		// the same for UTF-8 text, with the offsets in bytes
+		static auto build(const uchar* data, int length,
+						  QVector<int>& index,
+						  InstructionSet set = instructionSet()) -> bool;
+
+		// the offset of the first byte of the first invalid sequence
+		// in `data`, or -1 if there is none. Overlong forms,
+		// surrogates, code points past U+10FFFF, and sequences cut
+		// short, by the next character or the end of the text, are
+		// all invalid. Blocks of ASCII are passed over whole, and the
+		// rest is checked with table lookups on all of a block at
+		// once; only a block found to be invalid is looked at byte
+		// by byte
+		static auto findInvalidUtf8(const uchar* data, int length,
+									InstructionSet set = instructionSet()) -> int;
+
+		// the offset of the next character at or after `from` that a
+		// writer has to escape, or `length` if there is none; what
+		// comes before it is printable ASCII other than a quote or a
+		// backslash, and can be copied as it is. The character found
+		// is one of those two, a control character, or anything past
+		// ASCII, which the writer has to look at itself. The text is
+		// checked 16 or 32 characters at a time
+		static auto findEscape(const ushort* data, int from, int length,
+							   InstructionSet set = instructionSet()) -> int;
+};
+
+}
+
+#endif // JSON_STRUCTURAL_INDEX_P_H
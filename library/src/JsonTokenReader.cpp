@@ -0,0 +1,520 @@
+// header file
+#include <JsonDataTree/JsonTokenReader.h>
+
+// internal data
+#include <QSharedData>
+#include <QByteArray>
+#include <QVector>
+
+// the tokens themselves
+#include "JsonLexer_p.h"
+
+// private data class
+class JSON::JsonTokenReaderPrivate : public QSharedData {
+	public:
+		// what is allowed to come next
+		enum State {
+			ExpectValue,
+			ExpectValueOrEnd,   // right after [
+			ExpectKey,
+			ExpectKeyOrEnd,     // right after {
+			ExpectCommaOrEnd,
+			Done
+		};
+
+		// an array or object that has been started but not ended
+		struct Container {
+			bool isObject;
+			int start;
+		};
+
+		// how much is read from a device at a time, at least
+		static const int chunkSize = 1 << 16;
+
+		JsonTokenReaderPrivate()
+			:	utf8(false), io(nullptr), base(0), pos(0), failed(false),
+				state(ExpectValue), type(JsonTokenReader::NoToken),
+				offset(0), length(0), boolean(false) { }
+
+		// the text; only one of these is used
+		QString text;
+		QByteArray bytes;
+		bool utf8;
+
+		// the device the rest of `bytes` is read from as it is
+		// needed, until it runs out
+		QIODevice* io;
+		// where `bytes` starts in the text; what comes before
+		// the current token is dropped as the reader goes on
+		int base;
+
+		// where the next token is read from
+		int pos;
+		bool failed;
+		JsonReaderErrors errors;
+
+		State state;
+		QVector<Container> open;
+
+		// the current token
+		JsonTokenReader::TokenType type;
+		int offset;
+		int length;
+		QString string;
+		JsonNumber number;
+		bool boolean;
+
+		// set the text to read from a device
+		auto read(QIODevice* io) -> void;
+
+		// read more of the device; false if there is no more
+		auto fill() -> bool;
+
+		// drop the text before the current token, once it
+		// is most of what is held
+		auto discard() -> void;
+
+		// a cursor at the current position in the text
+		template <class Char>
+		auto cursor(JsonReaderErrors* found) -> JsonCursor<Char>;
+
+		// read the next token, or skip to the end of the current
+		// array or object, reading more of the device and starting
+		// over whenever the token may go on past what is held
+		template <class Char>
+		auto readToken(bool skipping) -> JsonTokenReader::TokenType;
+
+		// read the next token
+		template <class Char>
+		auto next(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType;
+
+		// read a value starting at the cursor
+		template <class Char>
+		auto readValue(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType;
+
+		// skip to the end of the array or object that was just started
+		template <class Char>
+		auto skipContainer(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType;
+
+		// make the token the current one
+		auto token(JsonTokenReader::TokenType tokenType,
+				   int start, int end) -> JsonTokenReader::TokenType;
+
+		// what comes after a whole value
+		auto afterValue() -> void;
+};
+
+using namespace JSON;
+
+JsonTokenReader::JsonTokenReader()
+	:	d(new JsonTokenReaderPrivate) { }
+
+JsonTokenReader::JsonTokenReader(QString text)
+	:	d(new JsonTokenReaderPrivate) {
+	d->text = text;
+}
+
+JsonTokenReader::JsonTokenReader(QIODevice* io)
+	:	d(new JsonTokenReaderPrivate) {
+	d->read(io);
+}
+
+JsonTokenReader::JsonTokenReader(const JsonTokenReader& other)
+	:	d(other.d) { }
+
+JsonTokenReader::~JsonTokenReader() { }
+
+auto JsonTokenReader::operator= (const JsonTokenReader& other) -> JsonTokenReader& {
+	if (this == &other) return *this;
+	d = other.d;
+	return *this;
+}
+
+auto JsonTokenReader::next() -> TokenType {
+	if (d->failed) {
+		return Invalid;
+	}
+	if (d->utf8) {
+		return d->readToken<uchar>(false);
+	}
+	return d->readToken<ushort>(false);
+}
+
+auto JsonTokenReader::skipValue() -> bool {
+	switch (d->type) {
+		case Key:
+			// get to the value
+			if (next() == Invalid) {
+				return false;
+			}
+			if (d->type != StartObject && d->type != StartArray) {
+				// that was the whole thing
+				return true;
+			}
+			break;
+		case StartObject:
+		case StartArray:
+			break;
+		default:
+			// nothing to skip
+			return d->type != Invalid;
+	}
+	if (d->utf8) {
+		return d->readToken<uchar>(true) != Invalid;
+	}
+	return d->readToken<ushort>(true) != Invalid;
+}
+
+auto JsonTokenReader::tokenType() const -> TokenType {
+	return d->type;
+}
+
+auto JsonTokenReader::toString() const -> QString {
+	switch (d->type) {
+		case Key:
+		case String:
+			return d->string;
+		case Number:
+		case Boolean:
+		case Null:
+			if (d->utf8) {
+				return QString::fromUtf8(d->bytes.constData() + d->offset,
+										 d->length);
+			}
+			return d->text.mid(d->offset, d->length);
+		default:
+			return QString();
+	}
+}
+
+auto JsonTokenReader::toDouble() const -> double {
+	return d->type == Number ? d->number.toDouble() : 0.0;
+}
+
+auto JsonTokenReader::isInteger() const -> bool {
+	return d->type == Number && d->number.kind != JsonNumber::Double;
+}
+
+auto JsonTokenReader::toInt64() const -> qint64 {
+	if (d->type != Number) {
+		return 0;
+	}
+	bool exact;
+	return d->number.toInteger<qint64>(exact);
+}
+
+auto JsonTokenReader::toUInt64() const -> quint64 {
+	if (d->type != Number) {
+		return 0;
+	}
+	bool exact;
+	return d->number.toInteger<quint64>(exact);
+}
+
+auto JsonTokenReader::toBoolean() const -> bool {
+	return d->type == Boolean && d->boolean;
+}
+
+auto JsonTokenReader::offset() const -> int {
+	return d->base + d->offset;
+}
+
+auto JsonTokenReader::depth() const -> int {
+	return d->open.size();
+}
+
+auto JsonTokenReader::errors() const -> JsonReaderErrors {
+	return d->errors;
+}
+
+auto JsonTokenReaderPrivate::read(QIODevice* io) -> void {
+	// UTF-16 and UTF-32 text still has to be decoded by
+	// QTextStream; everything else is read as UTF-8
+	QByteArray bom = io->peek(2);
+	if (bom == "\xff\xfe" || bom == "\xfe\xff") {
+		QTextStream stream(io);
+		text = stream.readAll();
+		return;
+	}
+	this->io = io;
+	utf8 = true;
+	while (bytes.size() < 3 && fill()) { }
+	// a byte order mark is not part of the text, but it
+	// still counts towards the offsets
+	pos = byteOrderMarkLength(reinterpret_cast<const uchar*>(bytes.constData()),
+							  bytes.size());
+}
+
+auto JsonTokenReaderPrivate::fill() -> bool {
+	if (!io) {
+		return false;
+	}
+	// the more that has to be held at once, the more is
+	// read at a time, so a long token is only read over
+	// a few times
+	QByteArray more = io->read(qMax(chunkSize, bytes.size()));
+	if (more.isEmpty()) {
+		io = nullptr;
+		return false;
+	}
+	bytes += more;
+	return true;
+}
+
+auto JsonTokenReaderPrivate::discard() -> void {
+	// the current token is kept, since skipValue() goes
+	// back to the [ or { it is at
+	int drop = offset;
+	if (!io || drop < chunkSize || drop < bytes.size() / 2) {
+		return;
+	}
+	bytes.remove(0, drop);
+	base += drop;
+	pos -= drop;
+	offset -= drop;
+	// those further out only matter for their errors,
+	// which are put back where they were in the text
+	for (Container& container : open) {
+		container.start -= drop;
+	}
+}
+
+template <>
+auto JsonTokenReaderPrivate::cursor(JsonReaderErrors* found) -> JsonCursor<ushort> {
+	JsonCursor<ushort> cursor(text.utf16(), text.length(), found);
+	cursor.pos += pos;
+	return cursor;
+}
+
+template <>
+auto JsonTokenReaderPrivate::cursor(JsonReaderErrors* found) -> JsonCursor<uchar> {
+	JsonCursor<uchar> cursor(reinterpret_cast<const uchar*>(bytes.constData()),
+							 bytes.size(), found);
+	cursor.pos += pos;
+	return cursor;
+}
+
+template <class Char>
+auto JsonTokenReaderPrivate::readToken(bool skipping) -> JsonTokenReader::TokenType {
+	discard();
+	State before = state;
+	QVector<Container> opened = open;
+	while (true) {
+		JsonReaderErrors found;
+		JsonCursor<Char> cursor = this->cursor<Char>(&found);
+		JsonTokenReader::TokenType ans = skipping ? skipContainer(cursor) : next(cursor);
+		// a token that ran into the end of what is held may go
+		// on, or be fine, past it; a mistake has to be made sure
+		// of the same way
+		if ((cursor.failed || cursor.atEnd()) && fill()) {
+			state = before;
+			open = opened;
+			continue;
+		}
+		for (const JsonReaderError& error : found) {
+			errors.addError(error.type(), base + error.offset());
+		}
+		pos = cursor.offset();
+		failed = cursor.failed;
+		if (failed) {
+			type = JsonTokenReader::Invalid;
+			return type;
+		}
+		return ans;
+	}
+}
+
+template <class Char>
+auto JsonTokenReaderPrivate::next(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType {
+	// skip white space and comments
+	JsonLexer::skipNonData(cursor);
+	if (cursor.failed) {
+		return JsonTokenReader::Invalid;
+	}
+
+	int start = cursor.offset();
+	switch (state) {
+		case ExpectValueOrEnd:
+			if (cursor.peek() == ']') {
+				cursor.advance();
+				open.removeLast();
+				afterValue();
+				return token(JsonTokenReader::EndArray, start, start + 1);
+			}
+			return readValue(cursor);
+		case ExpectValue:
+			return readValue(cursor);
+		case ExpectKeyOrEnd:
+			if (cursor.peek() == '}') {
+				cursor.advance();
+				open.removeLast();
+				afterValue();
+				return token(JsonTokenReader::EndObject, start, start + 1);
+			}
+			// fall through
+		case ExpectKey: {
+			if (cursor.peek() != '\"') {
+				// has to be a string
+				cursor.error(JsonReaderError::ObjectWithNonStringKey,
+							 start + 1);
+				return JsonTokenReader::Invalid;
+			}
+
+			// read in the key
+			QString key = JsonLexer::readString(cursor);
+			if (cursor.failed) return JsonTokenReader::Invalid;
+			int end = cursor.offset();
+
+			// now skip white space/comments
+			JsonLexer::skipNonData(cursor);
+			if (cursor.failed) return JsonTokenReader::Invalid;
+
+			// read in the :
+			if (cursor.peek() != ':') {
+				cursor.error(JsonReaderError::ObjectWithMissingColon,
+							 cursor.offset() + 1);
+				return JsonTokenReader::Invalid;
+			}
+			cursor.advance();
+			state = ExpectValue;
+			string = key;
+			return token(JsonTokenReader::Key, start, end);
+		}
+		case ExpectCommaOrEnd: {
+			const Container& container = open.last();
+			ushort c = cursor.peek();
+			if (c == ',') {
+				// skip to the next value
+				cursor.advance();
+				JsonLexer::skipNonData(cursor);
+				if (cursor.failed) return JsonTokenReader::Invalid;
+
+				if (container.isObject) {
+					if (cursor.peek() == '}') {
+						// , and } can't happen next to each other
+						cursor.error(JsonReaderError::ObjectWithExtraComma,
+									 cursor.offset() + 1);
+						return JsonTokenReader::Invalid;
+					}
+					state = ExpectKey;
+				} else {
+					if (cursor.peek() == ']') {
+						// , and ] can't happen next to each other
+						cursor.error(JsonReaderError::ArrayWithExtraComma,
+									 cursor.offset() + 1);
+						return JsonTokenReader::Invalid;
+					}
+					state = ExpectValue;
+				}
+				return next(cursor);
+			}
+			if (container.isObject && c == '}') {
+				cursor.advance();
+				open.removeLast();
+				afterValue();
+				return token(JsonTokenReader::EndObject, start, start + 1);
+			}
+			if (!container.isObject && c == ']') {
+				cursor.advance();
+				open.removeLast();
+				afterValue();
+				return token(JsonTokenReader::EndArray, start, start + 1);
+			}
+			// wasn't a separator, so we had to be done
+			cursor.error(container.isObject
+							? JsonReaderError::ObjectWithNoClosingBrace
+							: JsonReaderError::ArrayWithNoClosingBracket,
+						 container.start);
+			return JsonTokenReader::Invalid;
+		}
+		case Done:
+			// anything after the value is ignored, as it is by JsonReader
+			break;
+	}
+	return token(JsonTokenReader::EndOfDocument, start, start);
+}
+
+template <class Char>
+auto JsonTokenReaderPrivate::readValue(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType {
+	int start = cursor.offset();
+	// determine what to do based on the first char
+	switch (cursor.peek()) {
+		case '{': // object
+			cursor.advance();
+			open.append(Container { true, start });
+			state = ExpectKeyOrEnd;
+			return token(JsonTokenReader::StartObject, start, start + 1);
+		case '[': // array
+			cursor.advance();
+			open.append(Container { false, start });
+			state = ExpectValueOrEnd;
+			return token(JsonTokenReader::StartArray, start, start + 1);
+		case '\"': // string
+			string = JsonLexer::readString(cursor);
+			if (cursor.failed) return JsonTokenReader::Invalid;
+			afterValue();
+			return token(JsonTokenReader::String, start, cursor.offset());
+		case '0': case '1': case '2':
+		case '3': case '4': case '5':
+		case '6': case '7': case '8':
+		case '9': case '-': // numbers
+			number = JsonLexer::readNumber(cursor);
+			if (cursor.failed) return JsonTokenReader::Invalid;
+			afterValue();
+			return token(JsonTokenReader::Number, start, cursor.offset());
+		case 'f': // false
+			if (JsonLexer::readLiteral(cursor, "false")) {
+				boolean = false;
+				afterValue();
+				return token(JsonTokenReader::Boolean, start, cursor.offset());
+			}
+			break;
+		case 't': // true
+			if (JsonLexer::readLiteral(cursor, "true")) {
+				boolean = true;
+				afterValue();
+				return token(JsonTokenReader::Boolean, start, cursor.offset());
+			}
+			break;
+		case 'n': // null
+			if (JsonLexer::readLiteral(cursor, "null")) {
+				afterValue();
+				return token(JsonTokenReader::Null, start, cursor.offset());
+			}
+			break;
+		default: // unrecognizable
+			break;
+	}
+	// the offset is one past the start, as it always has been
+	cursor.error(JsonReaderError::UnknownLiteral, start + 1);
+	return JsonTokenReader::Invalid;
+}
+
+template <class Char>
+auto JsonTokenReaderPrivate::skipContainer(JsonCursor<Char>& cursor) -> JsonTokenReader::TokenType {
+	const Container container = open.last();
+	// go back to the [ or { and pass over the whole thing, only
+	// matching up the brackets and quotes
+	cursor.pos = cursor.begin + container.start;
+	JsonLexer::skipValue(cursor);
+	if (cursor.failed) return JsonTokenReader::Invalid;
+	open.removeLast();
+	afterValue();
+	int end = cursor.offset();
+	return token(container.isObject
+					? JsonTokenReader::EndObject
+					: JsonTokenReader::EndArray,
+				 end - 1, end);
+}
+
+auto JsonTokenReaderPrivate::token(JsonTokenReader::TokenType tokenType,
+								   int start, int end) -> JsonTokenReader::TokenType {
+	type = tokenType;
+	offset = start;
+	length = end - start;
+	return type;
+}
+
+auto JsonTokenReaderPrivate::afterValue() -> void {
+	state = open.isEmpty() ? Done : ExpectCommaOrEnd;
+}
@@ -0,0 +1,174 @@
+#ifndef JSON_TREE_BUILDER_P_H
+#define JSON_TREE_BUILDER_P_H
+
+// for the data
+#include <JsonDataTree/JsonValue.h>
+#include <JsonDataTree/JsonArray.h>
+#include <JsonDataTree/JsonObject.h>
+#include <QString>
+#include <QVector>
+
+// for std::move
+#include <utility>
+
+// for strings left in the text
+#include "JsonLazyValue_p.h"
+
+// Internal; not part of the public API.
+
+namespace JSON
+{
+
+// what a read that is waited on asynchronously reports to,
+// and is canceled through
+class JsonReadWatch {
+	public:
+		virtual ~JsonReadWatch() { }
+
+		// the parser got to `offset` in text `length` long;
+		// this is `false` to stop it there
+		virtual auto reached(int offset, int length) -> bool = 0;
+};
+
+// builds the values out of the events the parser emits
+class JsonTreeBuilder {
+	public:
+		// how many values go by between reports to the watch
+		static const int watchInterval = 1 << 10;
+
+		JsonTreeBuilder()
+			:	watch(nullptr), serial(false), countdown(watchInterval) { }
+
+		auto startObject() -> bool {
+			stack.append(Frame(true));
+			return true;
+		}
+
+		auto key(const QString& key) -> bool {
+			stack.last().key = key;
+			return true;
+		}
+
+		auto endObject() -> bool {
+			JsonValue value(std::move(stack.last().object));
+			stack.removeLast();
+			return add(value);
+		}
+
+		// an array that was put together somewhere else
+		auto array(const JsonArray& array) -> bool {
+			return add(JsonValue(array));
+		}
+
+		auto startArray() -> bool {
+			stack.append(Frame(false));
+			return true;
+		}
+
+		auto endArray() -> bool {
+			JsonValue value(std::move(stack.last().array));
+			stack.removeLast();
+			return add(value);
+		}
+
+		auto string(const QString& value) -> bool {
+			return add(value);
+		}
+
+		// a string without escapes, left where it is in `text`
+		template <class Char>
+		auto view(const Char* start, int length) -> bool {
+			return add(text->view(start, length));
+		}
+
+		auto number(double value) -> bool {
+			return add(value);
+		}
+
+		auto integer(qint64 value) -> bool {
+			return add(JsonValue(value));
+		}
+
+		auto unsignedInteger(quint64 value) -> bool {
+			return add(JsonValue(value));
+		}
+
+		auto boolean(bool value) -> bool {
+			return add(value);
+		}
+
+		auto null() -> bool {
+			return add(JsonValue::Null);
+		}
+
+		// the value read in; if the parser stopped half way,
+		// this is the outermost array or object as it was
+		auto result() const -> JsonValue {
+			if (stack.isEmpty()) {
+				return root;
+			}
+			const Frame& frame = stack.first();
+			if (frame.isObject) {
+				return frame.object;
+			}
+			return frame.array;
+		}
+
+		auto clear() -> void {
+			stack.clear();
+			root = JsonValue::Null;
+		}
+
+		// called between the values of an array or object; only
+		// now and then does this go as far as the watch
+		auto reached(int offset, int length) -> bool {
+			if (!watch || -- countdown > 0) {
+				return true;
+			}
+			countdown = watchInterval;
+			return watch->reached(offset, length);
+		}
+
+		// the text being read, if strings are left in it
+		QExplicitlySharedDataPointer<JsonLazyText> text;
+
+		// what is told how far the parser got, if anything
+		JsonReadWatch* watch;
+
+		// the text is never split up over the reader's pool; set
+		// when the parse may already be running on that pool
+		bool serial;
+
+	private:
+		// an array or object that is still being read
+		struct Frame {
+			Frame(bool isObject = false)
+				:	isObject(isObject) { }
+
+			bool isObject;
+			JsonArray array;
+			JsonObject object;
+			// the key of the value that comes next
+			QString key;
+		};
+
+		auto add(const JsonValue& value) -> bool {
+			if (stack.isEmpty()) {
+				root = value;
+			} else if (stack.last().isObject) {
+				Frame& frame = stack.last();
+				frame.object.insert(frame.key, value);
+			} else {
+				stack.last().array << value;
+			}
+			return true;
+		}
+
+		QVector<Frame> stack;
+		JsonValue root;
+		int countdown;
+};
+
+}
+
+#endif // JSON_TREE_BUILDER_P_H
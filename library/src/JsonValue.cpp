@@ -6,6 +6,12 @@
 
 // internal data
 #include <QSharedData>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <limits>
+
+// arrays and objects that are read when first used
+#include "JsonLazyValue_p.h"
 
 // for global variables
 #include <QGlobalStatic>
@@ -13,21 +19,60 @@
 // JsonValuePrivate internal data class
 class JSON::JsonValuePrivate : public QSharedData {
 	public:
+		// how a Number is held
+		enum NumberKind {
+			Double,
+			Signed,
+			Unsigned    // only for those too big to be Signed
+		};
+
+		// where a String left in the text it was read from is
+		class View {
+			public:
+				int offset;
+				int length;
+		};
+
 		JsonValue::Type type;
+		NumberKind kind;
 		union {
 			double number;
+			qint64 integer;
+			quint64 natural;
 			QString* string;
 			bool boolean;
 			JsonArray* array;
 			JsonObject* object;
+			// a String left in `text`, in which case `string` is unused
+			View view;
 		};
 
+		// the text a String was read from, if it was left there;
+		// otherwise null
+		QExplicitlySharedDataPointer<JsonLazyText> text;
+
+		// an array or object that has not been read yet, in which
+		// case `array` or `object` is null; otherwise null
+		QAtomicPointer<JsonLazySpan> lazy;
+		// what `lazy` is read from; it is kept after the read, since
+		// another thread may be waiting on its mutex
+		QExplicitlySharedDataPointer<JsonLazySource> source;
+
+		// read the array or object if it has not been yet
+		auto ensureRead() const -> void;
+
 		// deletes necessary objects and resets
 		// the type to Null
 		auto clean() -> void {
+			delete lazy.fetchAndStoreRelaxed(nullptr);
+			source.reset();
 			switch (type) {
 				case JsonValue::String:
-					delete string;
+					if (text) {
+						text.reset();
+					} else {
+						delete string;
+					}
 					break;
 				case JsonValue::Array:
 					delete array;
@@ -42,23 +87,33 @@ class JSON::JsonValuePrivate : public QSharedData {
 		}
 
 		JsonValuePrivate()
-			:	type(JsonValue::Null) { }
+			:	type(JsonValue::Null), kind(Double) { }
 
 		~JsonValuePrivate() {
 			clean();
 		}
 
 		JsonValuePrivate(const JsonValuePrivate& other)
-			:	type(other.type) {
+			:	type(other.type), kind(other.kind) {
+			other.ensureRead();
 			switch (type) {
 				case JsonValue::Number:
-					number = other.number;
+					if (kind == Double) {
+						number = other.number;
+					} else {
+						natural = other.natural;
+					}
 					break;
 				case JsonValue::Boolean:
 					boolean = other.boolean;
 					break;
 				case JsonValue::String:
-					string = new QString(*other.string);
+					if (other.text) {
+						text = other.text;
+						view = other.view;
+					} else {
+						string = new QString(*other.string);
+					}
 					break;
 				case JsonValue::Array:
 					array = new JsonArray(*other.array);
@@ -74,10 +129,44 @@ class JSON::JsonValuePrivate : public QSharedData {
 					break;
 			}
 		}
+
+		// a Number as a double, however it is held
+		auto toDouble() const -> double {
+			switch (kind) {
+				case Signed:
+					return double(integer);
+				case Unsigned:
+					return double(natural);
+				default:
+					return number;
+			}
+		}
 };
 
 using namespace JSON;
 
+auto JsonValuePrivate::ensureRead() const -> void {
+	if (!lazy.loadAcquire()) {
+		return;
+	}
+	// copies share this, so it may be read on another thread
+	// at the same time
+	QMutexLocker locker(&source->mutex);
+	JsonLazySpan* span = lazy.loadAcquire();
+	if (!span) {
+		return;
+	}
+	JsonValue value = span->read();
+	JsonValuePrivate* self = const_cast<JsonValuePrivate*>(this);
+	if (type == JsonValue::Array) {
+		self->array = new JsonArray(value.toArray());
+	} else {
+		self->object = new JsonObject(value.toObject());
+	}
+	self->lazy.storeRelease(nullptr);
+	delete span;
+}
+
 Q_GLOBAL_STATIC(JsonArray, invalidArray)
 Q_GLOBAL_STATIC(JsonObject, invalidObject)
 Q_GLOBAL_STATIC(JsonValue, invalidValueTwo)
@@ -103,6 +192,22 @@ JsonValue::JsonValue(JsonValue::Type type)
 	setType(type);
 }
 
+JsonValue::JsonValue(JsonLazyText* text, int offset, int length)
+	:	d(new JsonValuePrivate) {
+	d->type = String;
+	d->text = text;
+	d->view.offset = offset;
+	d->view.length = length;
+}
+
+JsonValue::JsonValue(JsonValue::Type type, JsonLazySpan* span)
+	:	d(new JsonValuePrivate) {
+	d->type = type;
+	d->array = nullptr;
+	d->source = span->source();
+	d->lazy.store(span);
+}
+
 auto JsonValue::setType(JsonValue::Type type) -> void {
 	d->clean();
 	d->type = type;
@@ -117,6 +222,7 @@ auto JsonValue::setType(JsonValue::Type type) -> void {
 			d->string = new QString();
 			break;
 		case Number:
+			d->kind = JsonValuePrivate::Double;
 			d->number = 0.0;
 			break;
 		case Boolean:
@@ -138,9 +244,35 @@ JsonValue::JsonValue(int val)
 }
 
 auto JsonValue::setInteger(int val) -> void {
+	setInt64(val);
+}
+
+JsonValue::JsonValue(qint64 val)
+	:	d(new JsonValuePrivate) {
+	setInt64(val);
+}
+
+auto JsonValue::setInt64(qint64 val) -> void {
 	d->clean();
 	d->type = Number;
-	d->number = val;
+	d->kind = JsonValuePrivate::Signed;
+	d->integer = val;
+}
+
+JsonValue::JsonValue(quint64 val)
+	:	d(new JsonValuePrivate) {
+	setUInt64(val);
+}
+
+auto JsonValue::setUInt64(quint64 val) -> void {
+	if (val <= quint64(std::numeric_limits<qint64>::max())) {
+		setInt64(qint64(val));
+		return;
+	}
+	d->clean();
+	d->type = Number;
+	d->kind = JsonValuePrivate::Unsigned;
+	d->natural = val;
 }
 
 JsonValue::JsonValue(double val)
@@ -151,6 +283,7 @@ JsonValue::JsonValue(double val)
 auto JsonValue::setDouble(double val) -> void {
 	d->clean();
 	d->type = Number;
+	d->kind = JsonValuePrivate::Double;
 	d->number = val;
 }
 
@@ -221,10 +354,17 @@ auto JsonValue::toInteger(bool* ok) const -> int {
 	if (ok) {
 		*ok = isNumber();
 	}
-	if (isNumber()) {
-		return (int) d->number;
+	if (!isNumber()) {
+		return 0;
+	}
+	switch (d->kind) {
+		case JsonValuePrivate::Signed:
+			return (int) d->integer;
+		case JsonValuePrivate::Unsigned:
+			return (int) d->natural;
+		default:
+			return (int) d->number;
 	}
-	return 0;
 }
 
 auto JsonValue::toDouble(bool* ok) const -> double {
@@ -232,11 +372,62 @@ auto JsonValue::toDouble(bool* ok) const -> double {
 		*ok = isNumber();
 	}
 	if (isNumber()) {
-		return d->number;
+		return d->toDouble();
 	}
 	return 0.0;
 }
 
+auto JsonValue::isInteger() const -> bool {
+	return isNumber() && d->kind != JsonValuePrivate::Double;
+}
+
+auto JsonValue::toInt64(bool* ok) const -> qint64 {
+	bool exact = isNumber();
+	qint64 ans = 0;
+	if (exact) {
+		switch (d->kind) {
+			case JsonValuePrivate::Signed:
+				ans = d->integer;
+				break;
+			case JsonValuePrivate::Unsigned:
+				// only ones past the largest qint64 are kept this way
+				ans = std::numeric_limits<qint64>::max();
+				exact = false;
+				break;
+			default:
+				ans = JsonNumber::clamp<qint64>(d->number, exact);
+				break;
+		}
+	}
+	if (ok) {
+		*ok = exact;
+	}
+	return ans;
+}
+
+auto JsonValue::toUInt64(bool* ok) const -> quint64 {
+	bool exact = isNumber();
+	quint64 ans = 0;
+	if (exact) {
+		switch (d->kind) {
+			case JsonValuePrivate::Signed:
+				exact = d->integer >= 0;
+				ans = exact ? quint64(d->integer) : 0;
+				break;
+			case JsonValuePrivate::Unsigned:
+				ans = d->natural;
+				break;
+			default:
+				ans = JsonNumber::clamp<quint64>(d->number, exact);
+				break;
+		}
+	}
+	if (ok) {
+		*ok = exact;
+	}
+	return ans;
+}
+
 auto JsonValue::isString() const -> bool {
 	return d->type == String;
 }
@@ -246,6 +437,9 @@ auto JsonValue::toString(bool* ok) const -> QString {
 		*ok = isString();
 	}
 	if (isString()) {
+		if (d->text) {
+			return d->text->slice(d->view.offset, d->view.length);
+		}
 		return *d->string;
 	}
 	return QString();
@@ -274,6 +468,7 @@ auto JsonValue::toArray(bool* ok) -> JsonArray& {
 		*ok = isArray();
 	}
 	if (isArray()) {
+		d->ensureRead();
 		return *d->array;
 	}
 	invalidArray->clear();
@@ -285,6 +480,7 @@ auto JsonValue::toArray(bool* ok) const -> JsonArray {
 		*ok = isArray();
 	}
 	if (isArray()) {
+		d->ensureRead();
 		return *d->array;
 	}
 	return JsonArray();
@@ -303,6 +499,7 @@ auto JsonValue::toObject(bool* ok) -> JsonObject& {
 		*ok = isObject();
 	}
 	if (isObject()) {
+		d->ensureRead();
 		return *d->object;
 	}
 	invalidObject->clear();
@@ -314,6 +511,7 @@ auto JsonValue::toObject(bool* ok) const -> JsonObject {
 		*ok = isObject();
 	}
 	if (isObject()) {
+		d->ensureRead();
 		return *d->object;
 	}
 	return JsonObject();
@@ -2,45 +2,22 @@
 #include <JsonDataTree/JsonWriter.h>
 
 // internal data
-#include <QSharedData>
+#include "JsonWriter_p.h"
 #include <QVariant>
-#include <JsonDataTree/JsonObject.h>
-#include <JsonDataTree/JsonArray.h>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QRunnable>
 
-using namespace JSON;
-
-// private data class
-class JSON::JsonWriterPrivate : public QSharedData {
-    public:
-        JsonValue data;
-
-        // write an indent to stream
-        auto writeIndent(QTextStream& stream, int indent) const -> void;
-
-        // write value to stream
-        auto writeValue(QTextStream& stream, JsonValue value,
-                        int indent) const -> void;
+// for compressed output
+#include "JsonCompression_p.h"
 
-        // write a string value to stream
-        auto writeString(QTextStream& stream, QString string) const -> void;
+// for writing numbers
+#include "JsonNumberFormat_p.h"
 
-        // write a numeric value to stream
-        auto writeNumber(QTextStream& stream, double number) const -> void;
+// for finding what strings need escaped
+#include "JsonStructuralIndex_p.h"
 
-        // write a boolean value to stream
-        auto writeBoolean(QTextStream& stream, bool boolean) const -> void;
-
-        // write a null value to stream
-        auto writeNull(QTextStream& stream) const -> void;
-
-        // write an object to stream
-        auto writeObject(QTextStream& stream, JsonObject object,
-                         int indent) const -> void;
-
-        // write an array to stream
-        auto writeArray(QTextStream& stream, JsonArray array,
-                        int indent) const -> void;
-};
+using namespace JSON;
 
 JsonWriter::JsonWriter()
     :    d(new JsonWriterPrivate) {
@@ -72,6 +49,39 @@ auto JsonWriter::setData(JsonValue data) -> void {
     d->data = data;
 }
 
+auto JsonWriter::getCompression() const -> Compression {
+    return d->compression;
+}
+
+auto JsonWriter::setCompression(Compression compression) -> void {
+    d->compression = compression;
+}
+
+auto JsonWriter::getFormat() const -> Format {
+    return d->format;
+}
+
+auto JsonWriter::setFormat(Format format) -> void {
+    d->format = format;
+}
+
+auto JsonWriter::getIndentation() const -> int {
+    return d->indentation;
+}
+
+auto JsonWriter::setIndentation(int spaces) -> void {
+    d->indentation = qMax(spaces, 0);
+    d->setUpIndent();
+}
+
+auto JsonWriter::getLineWidth() const -> int {
+    return d->lineWidth;
+}
+
+auto JsonWriter::setLineWidth(int width) -> void {
+    d->lineWidth = qMax(width, 0);
+}
+
 auto JsonWriter::string() const -> QString {
     QString str;
     writeTo(&str);
@@ -83,167 +93,530 @@ auto JsonWriter::writeTo(QString* str) const -> void {
     writeTo(stream);
 }
 
+auto JsonWriter::toUtf8() const -> QByteArray {
+    QByteArray bytes;
+    writeTo(&bytes);
+    return bytes;
+}
+
+auto JsonWriter::writeTo(QByteArray* bytes) const -> void {
+    JsonWriterPrivate::Utf8Output out(*bytes);
+    d->writeValue(out, d->data, 0);
+    out.flush();
+}
+
 auto JsonWriter::writeTo(QIODevice* io) const -> void {
-    QTextStream stream(io);
-    writeTo(stream);
+    d->write(io);
 }
 
 auto JsonWriter::writeTo(QTextStream& stream) const -> void {
-    d->writeValue(stream, d->data, 0);
+    JsonWriterPrivate::TextOutput out(stream);
+    d->writeValue(out, d->data, 0);
+}
+
+class JSON::JsonWriterPrivate::WriteTask : public QRunnable {
+    public:
+        // a file to write
+        WriteTask(const JsonWriterPrivate& writer, const QString& path)
+            :    writer(writer), path(path), io(nullptr) { }
+
+        // a device to write to
+        WriteTask(const JsonWriterPrivate& writer, QIODevice* io)
+            :    writer(writer), io(io) { }
+
+        // run the task on `pool`, for the future handed back
+        auto start(QThreadPool* pool) -> QFuture<void> {
+            future.reportStarted();
+            QFuture<void> ans = future.future();
+            pool->start(this);
+            return ans;
+        }
+
+        auto run() -> void override {
+            if (!future.isCanceled()) {
+                if (io) {
+                    writer.write(io, &future);
+                } else {
+                    writeFile();
+                }
+            }
+            future.reportFinished();
+        }
+
+    private:
+        // the file only replaces the one at `path` once it is all
+        // written; a failure is told to the caller by canceling
+        auto writeFile() -> void {
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly)) {
+                future.reportCanceled();
+                return;
+            }
+            writer.write(&file, &future);
+            // a canceled write is thrown away with `file`
+            if (!future.isCanceled() && !file.commit()) {
+                future.reportCanceled();
+            }
+        }
+
+        // a copy, so the writer can change in the meantime
+        const JsonWriterPrivate writer;
+        QString path;
+        QIODevice* io;
+        QFutureInterface<void> future;
+};
+
+auto JsonWriter::getThreadPool() const -> QThreadPool* {
+    return d->pool;
+}
+
+auto JsonWriter::setThreadPool(QThreadPool* pool) -> void {
+    d->pool = pool;
+}
+
+auto JsonWriter::writeToAsync(QString path) const -> QFuture<void> {
+    JsonWriterPrivate::WriteTask* task = new JsonWriterPrivate::WriteTask(*d, path);
+    return task->start(d->pool ? d->pool : QThreadPool::globalInstance());
+}
+
+auto JsonWriter::writeToAsync(QIODevice* io) const -> QFuture<void> {
+    JsonWriterPrivate::WriteTask* task = new JsonWriterPrivate::WriteTask(*d, io);
+    return task->start(d->pool ? d->pool : QThreadPool::globalInstance());
+}
+
+JsonWriterPrivate::Utf8Output::Utf8Output(QByteArray& bytes)
+    :    io(nullptr), bytes(bytes) {
+    begin = bytes.data();
+    pos = begin + bytes.size();
+    end = pos;
+}
+
+JsonWriterPrivate::Utf8Output::Utf8Output(QIODevice* io)
+    :    io(io), bytes(buffer) {
+    begin = buffer.data();
+    pos = begin;
+    end = begin;
+}
+
+auto JsonWriterPrivate::Utf8Output::flush() -> void {
+    int used = int(pos - begin);
+    if (io) {
+        if (used > 0) {
+            io->write(begin, used);
+        }
+        pos = begin;
+        return;
+    }
+    bytes.resize(used);
+    begin = bytes.data();
+    pos = begin + used;
+    end = pos;
+}
+
+auto JsonWriterPrivate::Utf8Output::makeRoom(int length) -> void {
+    int used = int(pos - begin);
+    if (io && used > 0) {
+        io->write(begin, used);
+        used = 0;
+    }
+    // the array is kept at its full size while it is written to,
+    // and only cut down to what was written at the end
+    int size = bytes.size();
+    if (size - used < length) {
+        size = qMax(qMax(size * 2, used + length), io ? bufferSize : 256);
+        bytes.resize(size);
+    }
+    begin = bytes.data();
+    pos = begin + used;
+    end = begin + size;
+}
+
+auto JsonWriterPrivate::Utf8Output::write(const QChar* text, int length) -> void {
+    const ushort* from = reinterpret_cast<const ushort*>(text);
+    const ushort* to = from + length;
+    while (from < to) {
+        // a slice at a time, so that the buffer for a device
+        // does not have to grow; a character takes three bytes
+        // at most, and a surrogate pair four
+        const ushort* stop = from + qMin(to - from, qptrdiff(4096));
+        int most = int(stop - from) * 3 + 1;
+        if (end - pos < most) {
+            makeRoom(most);
+        }
+        char* out = pos;
+        while (from < stop) {
+            // four ASCII characters at a time, while it lasts
+            if (stop - from >= 4) {
+                quint64 four;
+                std::memcpy(&four, from, sizeof(four));
+                if (!(four & Q_UINT64_C(0xff80ff80ff80ff80))) {
+                    out[0] = char(from[0]);
+                    out[1] = char(from[1]);
+                    out[2] = char(from[2]);
+                    out[3] = char(from[3]);
+                    from += 4;
+                    out += 4;
+                    continue;
+                }
+            }
+            ushort c = *from ++;
+            if (c < 0x80) {
+                *out ++ = char(c);
+            } else if (c < 0x800) {
+                *out ++ = char(0xc0 | (c >> 6));
+                *out ++ = char(0x80 | (c & 0x3f));
+            } else if (!QChar::isSurrogate(c)) {
+                *out ++ = char(0xe0 | (c >> 12));
+                *out ++ = char(0x80 | ((c >> 6) & 0x3f));
+                *out ++ = char(0x80 | (c & 0x3f));
+            } else if (QChar::isHighSurrogate(c) && from < to
+                       && QChar::isLowSurrogate(*from)) {
+                uint u = QChar::surrogateToUcs4(c, *from ++);
+                *out ++ = char(0xf0 | (u >> 18));
+                *out ++ = char(0x80 | ((u >> 12) & 0x3f));
+                *out ++ = char(0x80 | ((u >> 6) & 0x3f));
+                *out ++ = char(0x80 | (u & 0x3f));
+            } else {
+                // half a pair can't be encoded, so it is replaced
+                *out ++ = char(0xef);
+                *out ++ = char(0xbf);
+                *out ++ = char(0xbd);
+            }
+        }
+        pos = out;
+    }
+}
+
+auto JsonWriterPrivate::write(QIODevice* io, QFutureInterface<void>* future) const -> void {
+    if (compression != JsonWriter::NoCompression) {
+        // the text is compressed on another thread as it is written
+        JsonDeflateDevice deflated(io, compression == JsonWriter::GzipCompression);
+        Utf8Output out(&deflated);
+        writeValue(out, data, 0, future);
+        out.flush();
+        deflated.close();
+        return;
+    }
+    Utf8Output out(io);
+    writeValue(out, data, 0, future);
+    out.flush();
+}
+
+auto JsonWriterPrivate::setUpIndent() -> void {
+    static const int levels = 32;
+    if (indentation > 0) {
+        indent = QByteArray(1 + levels * indentation, ' ');
+    } else {
+        indent = QByteArray(1 + levels, '\t');
+    }
+    indent[0] = '\n';
+}
+
+auto JsonWriterPrivate::fitOnLine(JsonValue value, int room) const -> int {
+    // the arrays and objects being measured, innermost last; as in
+    // writeValue(), they are kept here rather than on the call stack,
+    // since a wide enough line fits any number of levels
+    QVector<QSharedPointer<Container>> open;
+    while (room >= 0) {
+        switch (value.getType()) {
+            case JsonValue::Array: {
+                JsonArray array = value.toArray();
+                // the brackets, and a comma and space between each two
+                room -= qMax(2 * array.size(), 2);
+                if (!array.isEmpty()) {
+                    open.append(QSharedPointer<Container>(new Container(array, true)));
+                }
+                break;
+            }
+            case JsonValue::Object: {
+                JsonObject object = value.toObject();
+                // the brackets, and a comma and space between each two
+                room -= qMax(2 * object.size(), 2);
+                if (!object.isEmpty()) {
+                    open.append(QSharedPointer<Container>(new Container(object, true)));
+                }
+                break;
+            }
+            case JsonValue::String:
+                if (value.toString().length() + 2 > room) {
+                    return -1;
+                }
+                // fall through
+            default: {
+                CountOutput scalar;
+                writeScalar(scalar, value);
+                room -= scalar.count;
+                break;
+            }
+        }
+
+        // find the next value to measure, leaving the arrays
+        // and objects that are done
+        while (true) {
+            if (open.isEmpty() || room < 0) {
+                return room;
+            }
+            Container& container = *open.last();
+            if (container.atEnd()) {
+                open.removeLast();
+                continue;
+            }
+            if (container.isObject) {
+                // the key in quotes, and a colon and space; a key
+                // is at least as long as it is unescaped
+                QString key = container.next.key();
+                room -= key.length() + 4;
+                if (room < 0) {
+                    return room;
+                }
+                CountOutput escaped;
+                writeString(escaped, key);
+                room -= escaped.count - key.length() - 2;
+                value = *container.next;
+                ++ container.next;
+            } else {
+                value = container.array.at(container.index);
+                ++ container.index;
+            }
+            break;
+        }
+    }
+    return room;
 }
 
-auto JsonWriterPrivate::writeIndent(QTextStream& stream,
-                                    int indent) const -> void {
-    for (int i = 0; i < indent; ++ i) {
-        stream << QChar('\t');    
+template <class Output>
+auto JsonWriterPrivate::writeLineBreak(Output& out,
+                                       int depth) const -> void {
+    int length = depth * qMax(indentation, 1);
+    int most = indent.size() - 1;
+    if (length <= most) {
+        out.write(indent.constData(), length + 1);
+        return;
+    }
+    // deeper than what is there, so write it a piece at a time
+    out.write(indent.constData(), most + 1);
+    for (length -= most; length > most; length -= most) {
+        out.write(indent.constData() + 1, most);
+    }
+    out.write(indent.constData() + 1, length);
+}
+
+template <class Output>
+auto JsonWriterPrivate::writeValue(Output& out, JsonValue value, int indent,
+                                   QFutureInterface<void>* future) const -> void {
+    // the arrays and objects being written, innermost last;
+    // keeping them here rather than on the call stack means
+    // that deeply nested values can not use it up
+    QVector<QSharedPointer<Container>> open;
+    // how many values of the outermost one have been started
+    int started = 0;
+    if (future) {
+        JsonValue::Type type = value.getType();
+        future->setProgressRange(0, type == JsonValue::Array ? value.toArray().size()
+                                    : type == JsonValue::Object ? value.toObject().size()
+                                    : 0);
+    }
+    bool compact = format == JsonWriter::CompactFormat;
+    while (true) {
+        JsonValue::Type type = value.getType();
+        // what is inside a line stays on it
+        bool inLine = compact || (!open.isEmpty() && open.last()->oneLine);
+        if (type == JsonValue::Array) {
+            JsonArray array = value.toArray();
+            if (array.isEmpty()) {
+                // if its empty, one-line [] works
+                out.write("[]");
+            } else {
+                out.write('[');
+                open.append(QSharedPointer<Container>(new Container(array,
+                    inLine || fitsOnLine(value))));
+            }
+        } else if (type == JsonValue::Object) {
+            JsonObject object = value.toObject();
+            if (object.isEmpty()) {
+                // if its empty, one-line {} works
+                out.write("{}");
+            } else {
+                out.write('{');
+                open.append(QSharedPointer<Container>(new Container(object,
+                    inLine || fitsOnLine(value))));
+            }
+        } else {
+            writeScalar(out, value);
+        }
+
+        // find the next value to write, closing the
+        // arrays and objects that are done first
+        while (true) {
+            if (open.isEmpty()) {
+                if (future) {
+                    future->setProgressValue(started);
+                }
+                return;
+            }
+            Container& container = *open.last();
+            int depth = indent + open.size();
+            if (container.atEnd()) {
+                // write the last ] or }
+                if (!container.oneLine) {
+                    writeLineBreak(out, depth - 1);
+                }
+                out.write(container.isObject ? '}' : ']');
+                open.removeLast();
+                continue;
+            }
+            if (future && open.size() == 1) {
+                future->setProgressValue(started ++);
+                if (future->isCanceled()) {
+                    return;
+                }
+            }
+            // everything but the first has a preceding comma
+            bool first = container.isObject
+                ? container.next == container.object.constBegin()
+                : container.index == 0;
+            if (!first) {
+                out.write(',');
+            }
+            if (!container.oneLine) {
+                writeLineBreak(out, depth);
+            } else if (!first && !compact) {
+                out.write(' ');
+            }
+            if (container.isObject) {
+                writeString(out, container.next.key());
+                if (compact) {
+                    out.write(':');
+                } else {
+                    out.write(": ");
+                }
+                value = *container.next;
+                ++ container.next;
+            } else {
+                value = container.array.at(container.index);
+                ++ container.index;
+            }
+            break;
+        }
     }
 }
 
-auto JsonWriterPrivate::writeValue(QTextStream& stream, JsonValue value,
-                                   int indent) const -> void {
-    JsonValue::Type type = value.getType();
-    switch (type) {
+template <class Output>
+auto JsonWriterPrivate::writeScalar(Output& out,
+                                    JsonValue value) const -> void {
+    switch (value.getType()) {
         case JsonValue::Number:
-            writeNumber(stream, value.toDouble());
+            if (value.isInteger()) {
+                writeInteger(out, value);
+            } else {
+                writeNumber(out, value.toDouble());
+            }
             break;
         case JsonValue::String:
-            writeString(stream, value.toString());
+            writeString(out, value.toString());
             break;
         case JsonValue::Boolean:
-            writeBoolean(stream, value.toBoolean());
-            break;
-        case JsonValue::Object:
-            writeObject(stream, value.toObject(), indent);
-            break;
-        case JsonValue::Array:
-            writeArray(stream, value.toArray(), indent);
+            writeBoolean(out, value.toBoolean());
             break;
         case JsonValue::Null:
         default:
-            writeNull(stream);
+            writeNull(out);
     }
 }
 
-auto JsonWriterPrivate::writeNumber(QTextStream& stream,
+template <class Output>
+auto JsonWriterPrivate::writeNumber(Output& out,
                                     double number) const -> void {
-    stream << number;
+    char text[JsonNumberFormat::maxLength];
+    out.write(text, JsonNumberFormat::formatDouble(number, text));
 }
 
-auto JsonWriterPrivate::writeString(QTextStream& stream,
+template <class Output>
+auto JsonWriterPrivate::writeInteger(Output& out,
+                                     JsonValue value) const -> void {
+    char text[JsonNumberFormat::maxLength];
+    // a double would round anything past 2^53
+    if (value.toDouble() < 0) {
+        out.write(text, JsonNumberFormat::formatInteger(value.toInt64(), text));
+    } else {
+        out.write(text, JsonNumberFormat::formatInteger(value.toUInt64(), text));
+    }
+}
+
+// how each ASCII character is escaped: 0 if it is written as it is,
+// 'u' if it is written as \u00XX, and the letter after the backslash
+// otherwise
+static const char asciiEscapes[0x80] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u'
+};
+
+template <class Output>
+auto JsonWriterPrivate::writeString(Output& out,
                                     QString string) const -> void {
-    stream << QChar('\"');
+    static const char hexDigits[] = "0123456789abcdef";
+    out.write('\"');
+    const QChar* text = string.constData();
+    const ushort* units = reinterpret_cast<const ushort*>(text);
+    int length = string.length();
+    // where the characters that are written as they are start
+    int run = 0;
     int i = 0;
-    while (i < string.count()) {
-        ushort c = string.at(i).unicode();
-        switch (c) {
-            /* Basic escape characters */
-            case '\"': // quote
-                stream << "\\\"";
-                break;
-            case '\\': // backslash
-                stream << "\\\\";
-                break;
-            case '/': // this can be, but doesn't have to be, escaped
-                // stream << "\\/";
-                break;
-            case '\b': // backspace character
-                stream << "\\b";
-                break;
-            case '\f': // formfeed
-                stream << "\\f";
-                break;
-            case '\n': // newline
-                stream << "\\n";
-                break;
-            case '\r': // linefeed
-                stream << "\\r";
-                break;
-            case '\t': // tab
-                stream << "\\t";
-                break;
-            /* Everything else */
-            default:
-                if (string.at(i).isPrint()) {
-                    stream << string.at(i);
-                } else {
-                    // not printable, and not escape,
-                    // so we need to \u it
-                    stream << "\\u";
-                    QString hex = QString::number(c, 16);
-                    while (hex.count() < 4) {
-                        hex = '0' + hex;
-                    }
-                    stream << hex;
-                }
-                break;
+    while ((i = JsonStructuralIndex::findEscape(units, i, length)) < length) {
+        ushort c = units[i];
+        char escape = c < 0x80 ? asciiEscapes[c] : 'u';
+        if (c >= 0x80 && text[i].isPrint()) {
+            // printable past ASCII is written as it is, and
+            // usually comes several at a time
+            for (++ i; i < length && units[i] >= 0x80 && text[i].isPrint(); ++ i) { }
+            continue;
+        }
+        out.write(text + run, i - run);
+        run = ++ i;
+        if (escape == 'u') {
+            // not printable, and not escape,
+            // so we need to \u it
+            char unicode[] = {
+                '\\', 'u',
+                hexDigits[c >> 12], hexDigits[(c >> 8) & 0xf],
+                hexDigits[(c >> 4) & 0xf], hexDigits[c & 0xf]
+            };
+            out.write(unicode, 6);
+        } else {
+            char basic[] = { '\\', escape };
+            out.write(basic, 2);
         }
-        ++ i;
     }
-    stream << QChar('\"');
+    out.write(text + run, length - run);
+    out.write('\"');
 }
 
-auto JsonWriterPrivate::writeBoolean(QTextStream& stream,
+template <class Output>
+auto JsonWriterPrivate::writeBoolean(Output& out,
                                      bool boolean) const -> void {
     if (boolean) {
-        stream << "true";
+        out.write("true");
     } else {
-        stream << "false";
+        out.write("false");
     }
 }
 
-auto JsonWriterPrivate::writeNull(QTextStream& stream) const -> void {
-    stream << "null";
+template <class Output>
+auto JsonWriterPrivate::writeNull(Output& out) const -> void {
+    out.write("null");
 }
 
-auto JsonWriterPrivate::writeArray(QTextStream& stream, JsonArray array,
-                                   int indent) const -> void {
-    // if its empty, one-line [] works
-    if (array.isEmpty()) {
-        stream << "[]";
-        return;
-    }
-    // write the first value
-    stream << "[\n";
-    writeIndent(stream, indent + 1);
-    writeValue(stream, array.first(), indent + 1);
-    // write the rest, with preceding comma
-    for (int i = 1; i < array.count(); ++ i) {
-        stream << ",\n";
-        writeIndent(stream, indent + 1);
-        writeValue(stream, array.at(i), indent + 1);
-    }
-    // write the last ]
-    stream << QChar('\n');
-    writeIndent(stream, indent);
-    stream << QChar(']');
-}
-
-auto JsonWriterPrivate::writeObject(QTextStream& stream, JsonObject object,
-                                    int indent) const -> void {
-    // if its empty, one-line {} works
-    if (object.isEmpty()) {
-        stream << "{}";
-        return;
-    }
-    // write the first key-value pair
-    stream << "{\n";
-    writeIndent(stream, indent + 1);
-    auto iter = object.constBegin();
-    writeString(stream, iter.key());
-    stream << ": ";
-    writeValue(stream, *iter, indent + 1);
-    ++ iter;
-    // write the rest, with preceding comma
-    while (iter != object.constEnd()) {
-        stream << ",\n";
-        writeIndent(stream, indent + 1);
-        writeString(stream, iter.key());
-        stream << ": ";
-        writeValue(stream, *iter, indent + 1);
-        ++ iter;
-    }
-    // write the ending }
-    stream << QChar('\n');
-    writeIndent(stream, indent);
-    stream << QChar('}');
-}
\ No newline at end of file
+// the ones JsonStreamWriter writes with
+template auto JsonWriterPrivate::writeValue(Utf8Output& out, JsonValue value, int indent,
+                                            QFutureInterface<void>* future) const -> void;
+template auto JsonWriterPrivate::writeLineBreak(Utf8Output& out, int depth) const -> void;
+template auto JsonWriterPrivate::writeString(Utf8Output& out, QString string) const -> void;
+template auto JsonWriterPrivate::writeNumber(Utf8Output& out, double number) const -> void;
+template auto JsonWriterPrivate::writeBoolean(Utf8Output& out, bool boolean) const -> void;
+template auto JsonWriterPrivate::writeNull(Utf8Output& out) const -> void;
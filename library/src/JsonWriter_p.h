@@ -0,0 +1,229 @@
+#ifndef JSON_WRITER_P_H
+#define JSON_WRITER_P_H
+
+// for the writer
+#include <JsonDataTree/JsonWriter.h>
+#include <JsonDataTree/JsonObject.h>
+#include <JsonDataTree/JsonArray.h>
+#include <QSharedData>
+#include <QSharedPointer>
+#include <QVector>
+#include <QFutureInterface>
+#include <QByteArray>
+#include <cstring>
+
+// Internal; not part of the public API.
+
+// private data class, also used by JsonStreamWriter to write with
+class JSON::JsonWriterPrivate : public QSharedData {
+    public:
+        // an array or object that is being written out
+        class Container {
+            public:
+                Container(JsonArray array, bool oneLine)
+                    :    isObject(false), oneLine(oneLine),
+                         array(array), index(0) { }
+
+                Container(JsonObject object, bool oneLine)
+                    :    isObject(true), oneLine(oneLine), index(0),
+                         object(object), next(this->object.constBegin()) { }
+
+                // check if everything in it has been written
+                auto atEnd() const -> bool {
+                    return isObject
+                        ? next == object.constEnd()
+                        : index >= array.size();
+                }
+
+                bool isObject;
+                // written without line breaks
+                bool oneLine;
+                JsonArray array;
+                int index;
+                JsonObject object;
+                JsonObject::const_iterator next;
+        };
+
+        // collects the text as UTF-8, in a byte array or on its way
+        // to a device, copying runs of it into place in one go
+        class Utf8Output {
+            public:
+                // append the text to `bytes`
+                explicit Utf8Output(QByteArray& bytes);
+
+                // write the text to `io`, a buffer full at a time
+                explicit Utf8Output(QIODevice* io);
+
+                // write out what is buffered, or, for a byte array,
+                // cut it down to what has been written
+                auto flush() -> void;
+
+                auto write(char c) -> void {
+                    if (pos == end) {
+                        makeRoom(1);
+                    }
+                    *pos ++ = c;
+                }
+
+                // ASCII text
+                auto write(const char* text, int length) -> void {
+                    if (end - pos < length) {
+                        makeRoom(length);
+                    }
+                    std::memcpy(pos, text, size_t(length));
+                    pos += length;
+                }
+
+                template <int N>
+                auto write(const char (&text)[N]) -> void {
+                    write(text, N - 1);
+                }
+
+                // UTF-16 text, encoded on the way
+                auto write(const QChar* text, int length) -> void;
+
+            private:
+                // make room for at least `length` more bytes
+                auto makeRoom(int length) -> void;
+
+                // how much is buffered for a device at most, unless
+                // a single write needs more
+                static const int bufferSize = 1 << 16;
+
+                QIODevice* io;
+                QByteArray buffer;
+                QByteArray& bytes;
+                char* begin;
+                char* pos;
+                char* end;
+        };
+
+        // passes the text on to a text stream
+        class TextOutput {
+            public:
+                explicit TextOutput(QTextStream& stream)
+                    :    stream(stream) { }
+
+                auto write(char c) -> void {
+                    stream << c;
+                }
+
+                auto write(const char* text, int length) -> void {
+                    stream << QLatin1String(text, length);
+                }
+
+                template <int N>
+                auto write(const char (&text)[N]) -> void {
+                    write(text, N - 1);
+                }
+
+                auto write(const QChar* text, int length) -> void {
+                    stream << QString::fromRawData(text, length);
+                }
+
+            private:
+                QTextStream& stream;
+        };
+
+        // only counts the characters
+        class CountOutput {
+            public:
+                CountOutput()
+                    :    count(0) { }
+
+                auto write(char) -> void {
+                    ++ count;
+                }
+
+                auto write(const char*, int length) -> void {
+                    count += length;
+                }
+
+                template <int N>
+                auto write(const char (&)[N]) -> void {
+                    count += N - 1;
+                }
+
+                auto write(const QChar*, int length) -> void {
+                    count += length;
+                }
+
+                int count;
+        };
+
+        // writes to a file or device on a thread in the pool,
+        // for someone waiting on its future
+        class WriteTask;
+
+        JsonWriterPrivate()
+            :    compression(JsonWriter::NoCompression), pool(nullptr),
+                 format(JsonWriter::IndentedFormat), indentation(0),
+                 lineWidth(0) {
+            setUpIndent();
+        }
+
+        JsonValue data;
+        JsonWriter::Compression compression;
+        QThreadPool* pool;
+        JsonWriter::Format format;
+        // spaces to a level, or 0 for a tab
+        int indentation;
+        int lineWidth;
+        // a line break and the indentation for the first few
+        // levels, to be written from in one go
+        QByteArray indent;
+
+        // fill in `indent` for the current indentation
+        auto setUpIndent() -> void;
+
+        // check if value is small enough to get a line of its own
+        auto fitsOnLine(JsonValue value) const -> bool {
+            return lineWidth > 0 && fitOnLine(value, lineWidth) >= 0;
+        }
+
+        // the room left on a line of `room` characters once value
+        // is written on it, or less than 0 if it doesn't fit
+        auto fitOnLine(JsonValue value, int room) const -> int;
+
+        // write the data to io as UTF-8, compressed if need be,
+        // telling `future` how far it got if given
+        auto write(QIODevice* io, QFutureInterface<void>* future = nullptr) const -> void;
+
+        // start a new line indented `depth` levels
+        template <class Output>
+        auto writeLineBreak(Output& out, int depth) const -> void;
+
+        // write value to out; this stops early if `future`
+        // is canceled
+        template <class Output>
+        auto writeValue(Output& out, JsonValue value, int indent,
+                        QFutureInterface<void>* future = nullptr) const -> void;
+
+        // write a string value to out, copying the runs between
+        // the characters that need escaped in one go
+        template <class Output>
+        auto writeString(Output& out, QString string) const -> void;
+
+        // write a numeric value to out, as text that reads back as
+        // exactly it, and is nearly always the shortest such text
+        template <class Output>
+        auto writeNumber(Output& out, double number) const -> void;
+
+        // write an integer to out, digit for digit
+        template <class Output>
+        auto writeInteger(Output& out, JsonValue value) const -> void;
+
+        // write a boolean value to out
+        template <class Output>
+        auto writeBoolean(Output& out, bool boolean) const -> void;
+
+        // write a null value to out
+        template <class Output>
+        auto writeNull(Output& out) const -> void;
+
+        // write a string, number, boolean, or null to out
+        template <class Output>
+        auto writeScalar(Output& out, JsonValue value) const -> void;
+};
+
+#endif // JSON_WRITER_P_H
@@ -0,0 +1,160 @@
+#include "Tests.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include "JsonCompression_p.h"
+
+#include <QBuffer>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// text that compresses some, but not down to nothing
+auto randomText(mt19937& random, int size) -> QByteArray {
+	static const char letters[] = "{}[]:, \"abcdefghij0123456789\n";
+	QByteArray text(size, ' ');
+	for (int i = 0; i < size; ++i) {
+		text[i] = letters[random() % (sizeof(letters) - 1)];
+	}
+	return text;
+}
+
+// `text` compressed, written in pieces of random sizes
+auto compress(mt19937& random, const QByteArray& text, bool gzip) -> QByteArray {
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	JsonDeflateDevice deflate(&buffer, gzip);
+	for (int pos = 0; pos < text.size(); ) {
+		int size = qMin(text.size() - pos, int(random() % 100000) + 1);
+		deflate.write(text.constData() + pos, size);
+		pos += size;
+	}
+	deflate.close();
+	return data;
+}
+
+// the text in `data`, read in pieces of random sizes, and whether
+// the stream was found to be broken
+auto inflate(mt19937& random, QByteArray data, bool& failed) -> QByteArray {
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	JsonInflateDevice inflate(&buffer);
+	QByteArray text;
+	while (true) {
+		QByteArray more = inflate.read(int(random() % 100000) + 1);
+		if (more.isEmpty()) {
+			break;
+		}
+		text += more;
+	}
+	failed = inflate.failed();
+	return text;
+}
+
+// whether reading a compressed document reports a broken stream
+auto readFails(QByteArray data) -> bool {
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	JsonReaderErrors errors;
+	JsonReader().read(&buffer, &errors);
+	for (int i = 0; i < errors.numErrors(); ++i) {
+		if (errors.get(i).type() == JsonReaderError::StreamFailure) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+auto testCompression() -> int {
+	mt19937 random(2014);
+	int failures = 0;
+
+	// through a deflate device and back, in both formats, with
+	// sizes around the size of the chunks the codec works on
+	for (int size : { 0, 1, 1000, 65535, 65536, 65537, 3 << 20 }) {
+		for (bool gzip : { true, false }) {
+			QByteArray text = randomText(random, size);
+			bool failed;
+			if (inflate(random, compress(random, text, gzip), failed) != text || failed) {
+				cerr << size << " bytes did not come back from "
+					 << (gzip ? "gzip" : "zlib") << " the same" << endl;
+				++failures;
+			}
+		}
+	}
+
+	// gzip files one after another are read as one, and
+	// anything else after the last of them is left alone
+	QByteArray first = randomText(random, 200000);
+	QByteArray second = randomText(random, 100);
+	QByteArray members = compress(random, first, true) + compress(random, second, true);
+	bool failed;
+	if (inflate(random, members, failed) != first + second || failed
+			|| inflate(random, members + "trailing", failed) != first + second || failed) {
+		cerr << "a gzip file of several members was not read whole" << endl;
+		++failures;
+	}
+
+	// a stream cut short, or with a byte wrong, is broken, and
+	// what came before the break can still be read
+	string numbers = "[";
+	for (int i = 0; numbers.size() < 300000; ++i) {
+		numbers += (i ? ", " : "") + to_string(random() % 100000);
+	}
+	numbers += "]";
+	QByteArray document(numbers.data(), int(numbers.size()));
+	QByteArray compressed = compress(random, document, true);
+	for (int cut : { 1, 4, 8, compressed.size() / 2, compressed.size() - 10 }) {
+		QByteArray truncated = compressed.left(compressed.size() - cut);
+		QByteArray text = inflate(random, truncated, failed);
+		if (!failed || !document.startsWith(text)
+				|| !readFails(truncated)) {
+			cerr << "a gzip stream without its last " << cut
+				 << " bytes was not found to be cut short" << endl;
+			++failures;
+		}
+	}
+	for (int at : { 10, compressed.size() / 3, compressed.size() - 6 }) {
+		QByteArray corrupt = compressed;
+		corrupt[at] = char(corrupt.at(at) ^ 0x55);
+		inflate(random, corrupt, failed);
+		if (!failed || !readFails(corrupt)) {
+			cerr << "a gzip stream with byte " << at
+				 << " changed was not found to be corrupt" << endl;
+			++failures;
+		}
+	}
+
+	// a device can go away in the middle of a stream, while its
+	// thread is waiting for room to put more text or for more input
+	QByteArray large = compress(random, randomText(random, 8 << 20), true);
+	for (int read : { 0, 1, 200000 }) {
+		QBuffer buffer(&large);
+		buffer.open(QIODevice::ReadOnly);
+		JsonInflateDevice* device = new JsonInflateDevice(&buffer);
+		device->read(read);
+		delete device;
+	}
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	QByteArray text = randomText(random, 1 << 20);
+	JsonDeflateDevice* deflate = new JsonDeflateDevice(&buffer, false);
+	deflate->write(text);
+	// without being closed first; this finishes the stream
+	delete deflate;
+	if (inflate(random, data, failed) != text || failed) {
+		cerr << "a deflate device did not finish its stream when destroyed" << endl;
+		++failures;
+	}
+	return failures;
+}
@@ -0,0 +1,199 @@
+#include "Tests.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include <QBuffer>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// a random document, with strings that need escaping, text
+// past ASCII, and bytes that are not UTF-8 in them
+auto randomDocument(mt19937& random, int depth) -> string {
+	static const char* strings[] = {
+		"\"abc\"", "\"a\\\"b\"", "\"\\\\\"", "\"x\\u00e9y\"", "\"\"",
+		"\"\xc3\xa9t\xc3\xa9\"", "\"\\ud83d\\ude00\"", "\"\xe4\xb8\xad\\n\"",
+		"\"\xf0\x9f\x98\x80!\"", "\"a\xff\xc3\"", "\"\xed\xa0\x80\xef\xbb\xbf\""
+	};
+	static const char* scalars[] = {
+		"true", "false", "null", "0", "-1.5e3", "123456789012345678901", "0.1"
+	};
+	switch (random() % (depth > 4 ? 2 : 4)) {
+		case 0:
+			return strings[random() % 11];
+		case 1:
+			return scalars[random() % 7];
+		case 2: {
+			string text = "[";
+			for (int i = 0, n = random() % 5; i < n; ++i) {
+				text += i ? (random() % 2 ? ", " : ",") : "";
+				text += randomDocument(random, depth + 1);
+			}
+			return text + "]";
+		}
+		default: {
+			string text = "{";
+			for (int i = 0, n = random() % 5; i < n; ++i) {
+				text += i ? ",\n" : "";
+				text += "\"k" + to_string(i) + "\" : " + randomDocument(random, depth + 1);
+			}
+			return text + "}";
+		}
+	}
+}
+
+// break a document the way text goes wrong, so that both
+// engines have errors to report
+auto damage(mt19937& random, string text) -> string {
+	static const char* pieces[] = { ",", "]", "}", "\"", "x", "\\", "/", ":" };
+	size_t at = text.empty() ? 0 : random() % text.size();
+	if (random() % 4 == 0 && !text.empty()) {
+		text.erase(at, 1);
+	} else {
+		text.insert(at, pieces[random() % 8]);
+	}
+	return text;
+}
+
+// what an engine read: the value written out, and the first error
+struct Result {
+	string text;
+	int error;
+	int offset;
+
+	auto operator== (const Result& other) const -> bool {
+		return text == other.text && error == other.error && offset == other.offset;
+	}
+};
+
+// the value written out, with the members of each object in the
+// order of their keys, since the order they come out in depends
+// on how the object was built
+auto canonical(const JsonValue& value) -> string {
+	if (value.isArray()) {
+		string text = "[";
+		for (const JsonValue& element : value.toArray()) {
+			text += canonical(element) + ",";
+		}
+		return text + "]";
+	}
+	if (value.isObject()) {
+		JsonObject object = value.toObject();
+		QList<QString> keys = object.keys();
+		std::sort(keys.begin(), keys.end());
+		string text = "{";
+		for (const QString& key : keys) {
+			text += canonical(key) + ":" + canonical(object.value(key)) + ",";
+		}
+		return text + "}";
+	}
+	return JsonWriter(value).string().toStdString();
+}
+
+auto result(const JsonValue& value, const JsonReaderErrors& errors) -> Result {
+	Result result = { canonical(value), JsonReaderError::NoError, -1 };
+	if (errors.numErrors() > 0) {
+		result.error = errors.get(0).type();
+		result.offset = errors.get(0).offset();
+	}
+	return result;
+}
+
+auto parse(const QString& text, JsonReader::Engine engine) -> Result {
+	JsonReader reader;
+	reader.setEngine(engine);
+	JsonReaderErrors errors;
+	JsonValue value = reader.parse(text, &errors);
+	return result(value, errors);
+}
+
+auto read(const string& text, JsonReader::Engine engine) -> Result {
+	QByteArray bytes(text.data(), int(text.size()));
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	JsonReader reader;
+	reader.setEngine(engine);
+	JsonReaderErrors errors;
+	JsonValue value = reader.read(&buffer, &errors);
+	return result(value, errors);
+}
+
+// the same, read into a document
+auto readDocument(const string& text, JsonReader::Engine engine) -> Result {
+	QByteArray bytes(text.data(), int(text.size()));
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	JsonReader reader;
+	reader.setEngine(engine);
+	JsonReaderErrors errors;
+	JsonDocument document = reader.readDocument(&buffer, &errors);
+	return result(document.root(), errors);
+}
+
+auto report(const char* what, const string& text, const Result& expected, const Result& got) -> void {
+	cerr << what << " differs between the engines for: " << text << endl
+		 << "  recursive descent: error " << expected.error << " at " << expected.offset
+		 << endl << expected.text << endl
+		 << "  structural index: error " << got.error << " at " << got.offset
+		 << endl << got.text << endl;
+}
+
+}
+
+auto testEngines() -> int {
+	mt19937 random(2014);
+	int failures = 0;
+	for (int i = 0; i < 5000; ++i) {
+		string text = randomDocument(random, 0);
+		if (i % 2) {
+			text = damage(random, text);
+		}
+		if (i % 5 == 0) {
+			text = " /* comment */ " + text;
+		}
+
+		QString unicode = QString::fromUtf8(text.c_str());
+		Result expected = parse(unicode, JsonReader::RecursiveDescentEngine);
+		Result got = parse(unicode, JsonReader::StructuralIndexEngine);
+		if (!(got == expected)) {
+			report("parse()", text, expected, got);
+			++failures;
+		}
+
+		expected = read(text, JsonReader::RecursiveDescentEngine);
+		got = read(text, JsonReader::StructuralIndexEngine);
+		if (!(got == expected)) {
+			report("read()", text, expected, got);
+			++failures;
+		}
+
+		// documents keep their strings in an arena of their own
+		for (JsonReader::Engine engine : { JsonReader::RecursiveDescentEngine,
+										   JsonReader::StructuralIndexEngine }) {
+			expected = read(text, engine);
+			got = readDocument(text, engine);
+			if (!(got == expected)) {
+				report("readDocument()", text, expected, got);
+				++failures;
+			}
+		}
+	}
+
+	// empty keys, strings, arrays, and objects take up no room at all
+	JsonDocument document = JsonReader().parseDocument("{\"\": [], \"a\": \"\", \"b\": {}}");
+	bool ok;
+	if (!document.follow(JsonPath({ JsonKey("") }), &ok).isArray() || !ok
+			|| document.follow("a").toString() != ""
+			|| !document.follow("b").isObject()) {
+		cerr << "a document lost its empty values" << endl;
+		++failures;
+	}
+	return failures;
+}
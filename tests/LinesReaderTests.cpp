@@ -0,0 +1,168 @@
+#include "Tests.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../library/include/Json.h"
+
+#include "JsonCompression_p.h"
+
+#include <QBuffer>
+#include <QMutex>
+#include <QMutexLocker>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// what was read from one line: its number, the value written out,
+// and the type and offset of each error
+struct Line {
+	qint64 number;
+	string value;
+	string errors;
+
+	auto operator== (const Line& other) const -> bool {
+		return number == other.number && value == other.value && errors == other.errors;
+	}
+
+	auto operator< (const Line& other) const -> bool {
+		return number < other.number;
+	}
+};
+
+auto line(qint64 number, const JsonValue& value, const JsonReaderErrors& errors) -> Line {
+	Line line = { number, JsonWriter(value).string().toStdString(), "" };
+	for (int i = 0; i < errors.numErrors(); ++i) {
+		line.errors += to_string(errors.get(i).type()) + "@"
+			+ to_string(errors.get(i).offset()) + " ";
+	}
+	return line;
+}
+
+// a log with blank lines, lines ending in \r\n, lines with mistakes
+// at different places, and a line longer than the default chunk
+auto makeLog() -> QByteArray {
+	string log;
+	for (int i = 0; i < 300; ++i) {
+		switch (i % 10) {
+			case 0:
+				log += "\n";
+				break;
+			case 1:
+				log += " \t\r\n";
+				break;
+			case 2:
+				log += "{\"id\": " + to_string(i) + ", \"crlf\": true}\r\n";
+				break;
+			case 3:
+				log += "{\"id\": " + to_string(i) + ", \"bad\": " + string(i % 7, ' ') + "tru}\n";
+				break;
+			case 4:
+				log += "[" + to_string(i) + ", \"unclosed\n";
+				break;
+			default:
+				log += "{\"id\": " + to_string(i) + ", \"text\": \"a, [b] \\\"c\\\" {d}\"}\n";
+				break;
+		}
+	}
+	string record = "{\"long\": [";
+	for (int i = 0; record.size() < 1200000; ++i) {
+		record += (i ? ", " : "") + to_string(i);
+	}
+	log += record + "]}\n";
+	// the last line does not need a newline
+	log += "{\"last\": null}";
+	return QByteArray(log.data(), int(log.size()));
+}
+
+// what each line reads as on its own
+auto expectedLines(const QByteArray& log) -> vector<Line> {
+	vector<Line> lines;
+	int start = 0;
+	for (qint64 number = 0; start < log.size(); ++number) {
+		int end = log.indexOf('\n', start);
+		if (end < 0) {
+			end = log.size();
+		}
+		QByteArray text = log.mid(start, end - start);
+		start = end + 1;
+		if (std::all_of(text.constBegin(), text.constEnd(), [](char c) {
+				return c == ' ' || c == '\t' || c == '\r';
+			})) {
+			continue;
+		}
+		QBuffer buffer(&text);
+		buffer.open(QIODevice::ReadOnly);
+		JsonReaderErrors errors;
+		JsonValue value = JsonReader().read(&buffer, &errors);
+		lines.push_back(line(number, value, errors));
+	}
+	return lines;
+}
+
+auto readLines(QByteArray data, int chunkSize, bool ordered, bool& ok) -> vector<Line> {
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	JsonLinesReader reader;
+	if (chunkSize > 0) {
+		reader.setChunkSize(chunkSize);
+	}
+	QMutex mutex;
+	vector<Line> lines;
+	ok = reader.read(&buffer, [&](qint64 number, JsonValue value, JsonReaderErrors errors) {
+		QMutexLocker lock(&mutex);
+		lines.push_back(line(number, value, errors));
+	}, ordered);
+	if (!ordered) {
+		std::sort(lines.begin(), lines.end());
+	}
+	return lines;
+}
+
+auto compress(const QByteArray& text) -> QByteArray {
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	JsonDeflateDevice deflate(&buffer, true);
+	deflate.write(text);
+	deflate.close();
+	return data;
+}
+
+}
+
+auto testLinesReader() -> int {
+	int failures = 0;
+	QByteArray log = makeLog();
+	QByteArray compressed = compress(log);
+	vector<Line> expected = expectedLines(log);
+
+	for (int chunkSize : { 1, 7, 0 }) {
+		for (bool ordered : { true, false }) {
+			for (bool gzip : { false, true }) {
+				bool ok = true;
+				vector<Line> got = readLines(gzip ? compressed : log, chunkSize, ordered, ok);
+				// a line with mistakes makes the whole read fail
+				if (ok || got != expected) {
+					cerr << "JsonLinesReader read the log differently with chunks of "
+						 << chunkSize << (ordered ? ", in order" : ", out of order")
+						 << (gzip ? ", compressed" : "") << endl;
+					for (size_t i = 0; i < got.size() && i < expected.size(); ++i) {
+						if (!(got[i] == expected[i])) {
+							cerr << "  line " << got[i].number << ": " << got[i].errors
+								 << "instead of line " << expected[i].number << ": "
+								 << expected[i].errors << endl;
+							break;
+						}
+					}
+					++failures;
+				}
+			}
+		}
+	}
+	return failures;
+}
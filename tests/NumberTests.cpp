@@ -0,0 +1,179 @@
+#include "Tests.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../library/include/Json.h"
+
+#include "JsonNumberFormat_p.h"
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+auto fromBits(quint64 bits) -> double {
+	double number;
+	memcpy(&number, &bits, sizeof(number));
+	return number;
+}
+
+auto toBits(double number) -> quint64 {
+	quint64 bits;
+	memcpy(&bits, &number, sizeof(bits));
+	return bits;
+}
+
+// the number `text` is read as
+auto read(const char* text) -> JsonValue {
+	JsonReaderErrors errors;
+	JsonValue value = JsonReader().parse(QString::fromLatin1(text), &errors);
+	return errors.numErrors() > 0 ? JsonValue() : value;
+}
+
+// check that `number` is written as text that strtod and the reader
+// read back bit for bit, and that whole numbers up to 2^53 are
+// written as integers
+auto check(double number) -> bool {
+	char text[JsonNumberFormat::maxLength + 1];
+	int length = JsonNumberFormat::formatDouble(number, text);
+	text[length] = '\0';
+
+	char* end;
+	double back = strtod(text, &end);
+	bool ok = end == text + length && toBits(back) == toBits(number)
+		&& toBits(read(text).toDouble()) == toBits(number);
+	if (ok && number == floor(number) && fabs(number) <= 9007199254740992.0) {
+		ok = strpbrk(text, ".eE") == nullptr;
+	}
+	if (!ok) {
+		cerr.precision(17);
+		cerr << "formatDouble(" << number << ") wrote " << text
+			 << ", which reads back as " << back << endl;
+	}
+	return ok;
+}
+
+}
+
+auto testNumbers() -> int {
+	const double twoTo53 = 9007199254740992.0;
+	vector<double> numbers = {
+		0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0 / 3.0, 1e21, 1e22, 1e23, 123456.789,
+		DBL_MAX, -DBL_MAX, DBL_MIN, -DBL_MIN, 5e-324, -5e-324,
+		nextafter(DBL_MIN, 0.0), nextafter(DBL_MAX, 0.0),
+		twoTo53 - 1, twoTo53, twoTo53 + 2, -(twoTo53 - 1), -twoTo53, -(twoTo53 + 2),
+		nextafter(twoTo53, 0.0), nextafter(twoTo53, DBL_MAX)
+	};
+	for (int exponent = -324; exponent <= 308; ++exponent) {
+		numbers.push_back(strtod(("1e" + to_string(exponent)).c_str(), nullptr));
+	}
+
+	mt19937_64 random(2014);
+	for (int i = 0; i < 100000; ++i) {
+		// any bit pattern, which is mostly very large or very small
+		numbers.push_back(fromBits(random()));
+		// subnormals, with a zero exponent
+		numbers.push_back(fromBits(random() & Q_UINT64_C(0x800fffffffffffff)));
+		// numbers of an everyday size
+		numbers.push_back(fromBits((random() & Q_UINT64_C(0x803fffffffffffff))
+			| Q_UINT64_C(0x3c00000000000000)));
+	}
+
+	int failures = 0;
+	for (double number : numbers) {
+		// JSON has no way to write these; they come out as null
+		if (std::isnan(number) || std::isinf(number)) {
+			continue;
+		}
+		if (!check(number)) {
+			++failures;
+		}
+	}
+	return failures;
+}
+
+auto testNumberReading() -> int {
+	int failures = 0;
+
+	// integers at the edges of the 64-bit types, and past them
+	struct Integer {
+		const char* text;
+		bool isInteger;
+		qint64 signedValue;
+		quint64 unsignedValue;
+	};
+	const Integer integers[] = {
+		{ "9223372036854775807", true, Q_INT64_C(9223372036854775807), Q_UINT64_C(9223372036854775807) },
+		{ "-9223372036854775808", true, -Q_INT64_C(9223372036854775807) - 1, 0 },
+		{ "9223372036854775808", true, Q_INT64_C(9223372036854775807), Q_UINT64_C(9223372036854775808) },
+		{ "18446744073709551615", true, Q_INT64_C(9223372036854775807), Q_UINT64_C(18446744073709551615) },
+		{ "18446744073709551616", false, Q_INT64_C(9223372036854775807), Q_UINT64_C(18446744073709551615) },
+		{ "-9223372036854775809", false, -Q_INT64_C(9223372036854775807) - 1, 0 }
+	};
+	for (const Integer& integer : integers) {
+		JsonValue value = read(integer.text);
+		if (value.isInteger() != integer.isInteger
+				|| value.toInt64() != integer.signedValue
+				|| value.toUInt64() != integer.unsignedValue
+				|| toBits(value.toDouble()) != toBits(strtod(integer.text, nullptr))) {
+			cerr << "the reader read " << integer.text << " wrong" << endl;
+			++failures;
+		}
+	}
+
+	// -0 keeps its sign
+	if (read("-0").isInteger() || !std::signbit(read("-0").toDouble())) {
+		cerr << "the reader read -0 as 0" << endl;
+		++failures;
+	}
+
+	// text strtod reads exactly: integers with 20 digits or more,
+	// every double written with 17 digits, and decimals with more
+	// digits than fit in 64 bits, halfway points among them
+	vector<string> texts = {
+		"100000000000000000000", "123456789012345678901234567890",
+		"99999999999999999999999", "100000000000000000000000",
+		"9007199254740993", "9007199254740993.00000000000000000001",
+		"2.2250738585072011e-308", "2.2250738585072012e-308",
+		"4.9406564584124654e-324", "2.4703282292062327e-324",
+		"2.4703282292062328e-324", "1.7976931348623157e308",
+		"0.1000000000000000055511151231257827021181583404541015625",
+		"0.1000000000000000055511151231257827021181583404541015624"
+	};
+	mt19937_64 random(2014);
+	for (int i = 0; i < 100000; ++i) {
+		double number = fromBits(random() & Q_UINT64_C(0x7fffffffffffffff));
+		if (std::isnan(number) || std::isinf(number)) {
+			continue;
+		}
+		char text[32];
+		snprintf(text, sizeof(text), "%.17g", number);
+		texts.push_back(text);
+
+		string digits = to_string(random() % 9 + 1);
+		for (int j = int(random() % 25); j > 0; --j) {
+			digits += char('0' + random() % 10);
+		}
+		int point = int(random() % digits.size()) + 1;
+		texts.push_back(digits.substr(0, point) + "." + digits.substr(point) + "0e"
+			+ to_string(int(random() % 600) - 300));
+	}
+	for (const string& text : texts) {
+		double expected = strtod(text.c_str(), nullptr);
+		double got = read(text.c_str()).toDouble();
+		if (toBits(got) != toBits(expected)) {
+			cerr.precision(17);
+			cerr << "the reader read " << text << " as " << got
+				 << " instead of " << expected << endl;
+			++failures;
+		}
+	}
+	return failures;
+}
@@ -0,0 +1,270 @@
+#include "Tests.h"
+
+#include <climits>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include <QBuffer>
+#include <QThreadPool>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// an array of records at least `size` bytes long, with strings
+// that look like the structure around them
+auto largeArray(int size, int seed) -> QByteArray {
+	string text = "[";
+	for (int i = 0; int(text.size()) < size; ++i) {
+		text += i ? ",\n" : "";
+		text += "{\"id\": " + to_string(seed * 1000000 + i)
+			+ ", \"name\": \"a [b, \\\"c\\\"], {d}\", \"tags\": [\"x\", 1.5, null]}";
+	}
+	text += "]";
+	return QByteArray(text.data(), int(text.size()));
+}
+
+// an array at least `size` bytes long, with strings full of what
+// the guesses at where an element starts look for: brackets, commas,
+// and quotes, escaped or not, and with backslashes before them
+auto trickyArray(int size, mt19937& random) -> string {
+	static const char* pieces[] = {
+		"[", "]", "{", "}", ",", ", ", ":", " ", "x", "\\\"", "\\\", ",
+		"\\\"]", "\\\\", "\\\\\\\",", "\\\": [\\\""
+	};
+	string text = "[";
+	for (int i = 0; int(text.size()) < size; ++i) {
+		text += i ? (random() % 2 ? ",\n" : ",") : "";
+		string quoted = "\"";
+		for (int j = random() % 12; j > 0; --j) {
+			quoted += pieces[random() % 15];
+		}
+		quoted += "\"";
+		switch (random() % 3) {
+			case 0:
+				text += quoted;
+				break;
+			case 1:
+				text += "[" + quoted + ", " + to_string(i) + "]";
+				break;
+			default:
+				text += "{" + quoted + ": " + quoted + ", \"n\": [" + quoted + "]}";
+				break;
+		}
+	}
+	return text + "]";
+}
+
+auto written(const JsonValue& value) -> string {
+	return JsonWriter(value).string().toStdString();
+}
+
+// the value written out, and the first error, if any
+auto outcome(const JsonValue& value, const JsonReaderErrors& errors) -> string {
+	if (errors.numErrors() > 0) {
+		return "error " + to_string(errors.get(0).type())
+			+ " at " + to_string(errors.get(0).offset());
+	}
+	return written(value);
+}
+
+// the value written out, and every error
+auto everything(const JsonValue& value, const JsonReaderErrors& errors) -> string {
+	string text = written(value);
+	for (int i = 0; i < errors.numErrors(); ++i) {
+		text += "\nerror " + to_string(errors.get(i).type())
+			+ " at " + to_string(errors.get(i).offset());
+	}
+	return text;
+}
+
+}
+
+auto testBatches() -> int {
+	// more documents than threads, each large enough that it
+	// would be split up over the pool if read on its own
+	QList<QByteArray> data;
+	for (int i = 0; i < 6; ++i) {
+		data.append(largeArray(1 << 20, i));
+	}
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(2);
+	JsonReader reader;
+	reader.setThreadPool(&pool);
+	QList<JsonReaderErrors> errors;
+	JsonArray values = reader.parseBatch(data, &errors);
+
+	int failures = 0;
+	JsonReader serial;
+	for (int i = 0; i < data.size(); ++i) {
+		if (i >= values.size() || errors.at(i).numErrors() > 0
+				|| written(values.at(i)) != written(serial.parse(QString::fromUtf8(data.at(i))))) {
+			cerr << "parseBatch() on a pool of 2 read document " << i
+				 << " differently than parse()" << endl;
+			++failures;
+		}
+	}
+	return failures;
+}
+
+auto testSessions() -> int {
+	// a good document, a bad one that is read part of the way, one
+	// whose errors nobody asks for, and a good one again
+	const char* documents[] = {
+		"{\"id\": 1, \"tags\": [\"a\", \"b\"], \"name\": \"first\"}",
+		"{\"id\": 2, \"tags\": [\"c\", tru], \"name\": \"second",
+		"[1, 2,, 3]",
+		"{\"id\": 3, \"tags\": [], \"name\": \"third\"}"
+	};
+	const int count = sizeof(documents) / sizeof(documents[0]);
+	JsonReader::Engine engines[] = {
+		JsonReader::RecursiveDescentEngine, JsonReader::StructuralIndexEngine
+	};
+	int failures = 0;
+
+	for (JsonReader::Engine engine : engines) {
+		for (bool utf8 : { true, false }) {
+			JsonReader reader;
+			reader.setEngine(engine);
+			JsonReaderSession session(reader);
+			QList<JsonValue> values;
+			QList<JsonReaderErrors> errors;
+			for (int i = 0; i < count; ++i) {
+				errors.append(JsonReaderErrors());
+				JsonReaderErrors* found = i == 2 ? nullptr : &errors.last();
+				values.append(utf8 ? session.parse(QByteArray(documents[i]), found)
+								   : session.parse(QString::fromUtf8(documents[i]), found));
+			}
+
+			// nothing read later changed what was read before
+			for (int i = 0; i < count; ++i) {
+				JsonReaderErrors expectedErrors;
+				JsonValue expected = reader.parse(QString::fromUtf8(documents[i]),
+												  i == 2 ? nullptr : &expectedErrors);
+				if (everything(values.at(i), errors.at(i))
+						!= everything(expected, expectedErrors)) {
+					cerr << "a session with engine " << engine
+						 << (utf8 ? " reading UTF-8" : " reading UTF-16")
+						 << " read document " << i << " differently than a reader:" << endl
+						 << everything(values.at(i), errors.at(i)) << endl;
+					++failures;
+				}
+			}
+		}
+	}
+	return failures;
+}
+
+auto testParallel() -> int {
+	mt19937 random(2014);
+	int failures = 0;
+	for (int i = 0; i < 4; ++i) {
+		string text = trickyArray((3 << 19) + i * 100000, random);
+		if (i == 3) {
+			// cut short, so that the last segment fails
+			text.resize(text.size() - 100);
+		}
+		QString unicode = QString::fromUtf8(text.c_str());
+		QByteArray bytes(text.data(), int(text.size()));
+
+		JsonReaderErrors errors;
+		JsonValue value = JsonReader().parse(unicode, &errors);
+		string expected = outcome(value, errors);
+
+		// one thread and two cut the array up differently
+		for (int threads = 1; threads <= 2; ++threads) {
+			QThreadPool pool;
+			pool.setMaxThreadCount(threads);
+			JsonReader reader;
+			reader.setThreadPool(&pool);
+
+			errors = JsonReaderErrors();
+			value = reader.parse(unicode, &errors);
+			bool same = outcome(value, errors) == expected;
+
+			QBuffer buffer(&bytes);
+			buffer.open(QIODevice::ReadOnly);
+			errors = JsonReaderErrors();
+			value = reader.read(&buffer, &errors);
+			if (!same || outcome(value, errors) != expected) {
+				cerr << "array " << i << " was read differently split up over a pool of "
+					 << threads << " than all at once" << endl;
+				++failures;
+			}
+		}
+	}
+	return failures;
+}
+
+auto testDepth() -> int {
+	const int depth = 100000;
+	QString text = QString(depth, '[') + QString(depth, ']');
+	JsonReader::Engine engines[] = {
+		JsonReader::RecursiveDescentEngine, JsonReader::StructuralIndexEngine
+	};
+	int failures = 0;
+
+	for (JsonReader::Engine engine : engines) {
+		// the [ that goes one level too deep is reported
+		JsonReader reader;
+		reader.setEngine(engine);
+		JsonReaderErrors errors;
+		reader.parse(text, &errors);
+		if (errors.numErrors() == 0
+				|| errors.get(0).type() != JsonReaderError::NestingTooDeep
+				|| errors.get(0).offset() != JsonReader::DefaultMaxDepth) {
+			cerr << "engine " << engine << " did not stop a document nested "
+				 << depth << " deep at its limit" << endl;
+			++failures;
+		}
+
+		// and without a limit, it is read all the way down
+		reader.setMaxDepth(0);
+		errors = JsonReaderErrors();
+		JsonValue value = reader.parse(text, &errors);
+		int levels = 0;
+		for (JsonValue inner = value; inner.getType() == JsonValue::Array;
+				inner = inner.toArray().isEmpty() ? JsonValue() : inner.toArray().first()) {
+			++levels;
+		}
+		if (errors.numErrors() > 0 || levels != depth) {
+			cerr << "engine " << engine << " read " << levels << " of "
+				 << depth << " levels without a limit" << endl;
+			++failures;
+		}
+
+		// a line wide enough for all of it is measured without
+		// a level of recursion for each level of the document
+		JsonWriter writer(value);
+		writer.setLineWidth(INT_MAX);
+		if (writer.string() != text) {
+			cerr << "writing a document nested " << depth
+				 << " deep on one line failed" << endl;
+			++failures;
+		}
+		writer.setFormat(JsonWriter::CompactFormat);
+		if (writer.string() != text) {
+			cerr << "writing a document nested " << depth
+				 << " deep compactly failed" << endl;
+			++failures;
+		}
+	}
+
+	// the stream reader has the same limit
+	JsonStreamReader stream;
+	stream.feed(text.toUtf8());
+	stream.finish();
+	if (stream.errors().numErrors() == 0
+			|| stream.errors().get(0).type() != JsonReaderError::NestingTooDeep
+			|| stream.errors().get(0).offset() != JsonReader::DefaultMaxDepth) {
+		cerr << "JsonStreamReader did not stop a document nested "
+			 << depth << " deep at its limit" << endl;
+		++failures;
+	}
+	return failures;
+}
@@ -0,0 +1,170 @@
+#include "Tests.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "JsonStructuralIndex_p.h"
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+typedef JsonStructuralIndex::InstructionSet InstructionSet;
+
+const char* setNames[] = { "Scalar", "Sse42", "Avx2" };
+
+// text made mostly of structural characters, quotes and backslashes,
+// so that strings open and close, and escapes land on every offset
+const ushort utf16Alphabet[] = {
+	'{', '}', '[', ']', ':', ',', '"', '"', '\\', '\\', ' ', '\n', 'a', '1',
+	'x', 0x1f, 0x7f, 0xe9, 0x4e2d, 0xd83d, 0xde00, 0xff00, '/'
+};
+const uchar utf8Alphabet[] = {
+	'{', '}', '[', ']', ':', ',', '"', '"', '\\', '\\', ' ', '\n', 'a', '1',
+	'x', 0xc3, 0xa9, 0xe4, 0xb8, 0xad, 0xf0, 0x9f, 0x98, 0x80, 0xc0, 0xed,
+	0xa0, 0xf4, 0x90, 0xff, '/'
+};
+const int utf16Size = sizeof(utf16Alphabet) / sizeof(utf16Alphabet[0]);
+const int utf8Size = sizeof(utf8Alphabet) / sizeof(utf8Alphabet[0]);
+
+// the lengths cover empty text, every tail shorter than a block, and
+// a few blocks; leaving '/' out most of the time lets the index build
+template <class Char>
+auto randomText(mt19937& random, const Char* alphabet, int size) -> vector<Char> {
+	vector<Char> text(random() % 300);
+	int used = random() % 4 ? size - 1 : size;
+	for (Char& c : text) {
+		c = alphabet[random() % used];
+	}
+	return text;
+}
+
+// The kernels are all checked against these, which look at the text
+// one character at a time in the most obvious way there is.
+
+// the index, built the way the second stage reads it: outside of
+// strings, a backslash escapes the next character too, so a quote
+// after an odd number of them does not open a string
+template <class Char>
+auto naiveBuild(const vector<Char>& text, QVector<int>& index) -> bool {
+	bool inString = false;
+	bool escaped = false;
+	bool inToken = false;
+	for (int i = 0; i < int(text.size()); ++i) {
+		ushort c = text[i];
+		bool wasEscaped = escaped;
+		escaped = !wasEscaped && c == '\\';
+		if (inString) {
+			if (c == '"' && !wasEscaped) {
+				index.append(i);
+				inString = false;
+			}
+			continue;
+		}
+		if (c == '"' && !wasEscaped) {
+			index.append(i);
+			inString = true;
+			inToken = false;
+		} else if (c == '/') {
+			return false;
+		} else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') {
+			index.append(i);
+			inToken = false;
+		} else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+			inToken = false;
+		} else if (!inToken) {
+			index.append(i);
+			inToken = true;
+		}
+	}
+	return !inString;
+}
+
+// decode each sequence in full, and see whether it is what it should be
+auto naiveInvalidUtf8(const vector<uchar>& text) -> int {
+	static const uint smallest[] = { 0, 0x80, 0x800, 0x10000 };
+	int length = int(text.size());
+	for (int i = 0; i < length; ) {
+		uint c = text[i];
+		int follow = c < 0x80 ? 0 : (c & 0xe0) == 0xc0 ? 1
+				   : (c & 0xf0) == 0xe0 ? 2 : (c & 0xf8) == 0xf0 ? 3 : -1;
+		if (follow < 0 || length - i <= follow) {
+			return i;
+		}
+		if (follow > 0) {
+			c &= 0x3f >> follow;
+		}
+		for (int k = 1; k <= follow; ++k) {
+			if ((text[i + k] & 0xc0) != 0x80) {
+				return i;
+			}
+			c = c << 6 | (text[i + k] & 0x3f);
+		}
+		if (c < smallest[follow] || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff)) {
+			return i;
+		}
+		i += follow + 1;
+	}
+	return -1;
+}
+
+auto naiveEscape(const vector<ushort>& text, int from) -> int {
+	int length = int(text.size());
+	while (from < length) {
+		ushort c = text[from];
+		if (c < 0x20 || c > 0x7e || c == '"' || c == '\\') {
+			break;
+		}
+		++from;
+	}
+	return from;
+}
+
+template <class Char>
+auto checkBuild(const vector<Char>& text, int set) -> bool {
+	QVector<int> expected, index;
+	bool expectedOk = naiveBuild(text, expected);
+	bool ok = JsonStructuralIndex::build(text.data(), int(text.size()),
+		index, InstructionSet(set));
+	return ok == expectedOk && (!ok || index == expected);
+}
+
+}
+
+auto testScanners() -> int {
+	mt19937 random(2014);
+	int failures = 0;
+	int best = JsonStructuralIndex::instructionSet();
+	for (int i = 0; i < 5000; ++i) {
+		vector<ushort> utf16 = randomText(random, utf16Alphabet, utf16Size);
+		vector<uchar> utf8 = randomText(random, utf8Alphabet, utf8Size);
+		int length = int(utf16.size());
+		int from = length ? int(random() % length) : 0;
+		int invalid = naiveInvalidUtf8(utf8);
+		int escape = naiveEscape(utf16, from);
+
+		// only the sets this CPU supports can be run
+		for (int set = JsonStructuralIndex::Scalar; set <= best; ++set) {
+			const char* failed = nullptr;
+			if (!checkBuild(utf16, set)) {
+				failed = "build (UTF-16)";
+			} else if (!checkBuild(utf8, set)) {
+				failed = "build (UTF-8)";
+			} else if (JsonStructuralIndex::findInvalidUtf8(utf8.data(),
+					int(utf8.size()), InstructionSet(set)) != invalid) {
+				failed = "findInvalidUtf8";
+			} else if (JsonStructuralIndex::findEscape(utf16.data(), from,
+					length, InstructionSet(set)) != escape) {
+				failed = "findEscape";
+			}
+			if (failed) {
+				cerr << failed << " with " << setNames[set]
+					 << " differs from the naive one on case " << i << endl;
+				++failures;
+			}
+		}
+	}
+	return failures;
+}
@@ -0,0 +1,90 @@
+#include "Tests.h"
+
+#include <iostream>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include <QBuffer>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// documents with UTF-8 sequences of every length and \u escapes,
+// surrogate pairs included, for the chunks to cut through
+const char* documents[] = {
+	"\"\xc3\xa9\"",
+	"\"\xe4\xb8\xad\xe6\x96\x87\"",
+	"\"\xf0\x9f\x98\x80\"",
+	"\"\\u00e9\\u4e2d\"",
+	"\"\\ud83d\\ude00\"",
+	"[\"a\xc3\xa9z\", \"\\u0041\\n\\\"\", \"\xf0\x9f\x98\x80\\ud83d\\ude00\xe4\xb8\xad\"]",
+	"{\"cl\xc3\xa9\": \"\\u00e9t\\u00e9\", \"\xf0\x9f\x98\x80\": [1.5e3, -0.25, true, null]}",
+	"\xef\xbb\xbf{\"bom\": \"\xe2\x82\xac\"}",
+	"12345.678e-2"
+};
+
+// read `text` with a stream reader, fed in chunks that start
+// at each offset where `cuts` has a `|`
+auto readChunks(const string& text, const string& cuts) -> string {
+	JsonStreamReader reader;
+	size_t start = 0;
+	for (size_t i = 0; i <= text.size(); ++i) {
+		if (i == text.size() || cuts[i] == '|') {
+			reader.feed(QByteArray(text.data() + start, int(i - start)));
+			start = i;
+		}
+	}
+	reader.finish();
+	if (reader.errors().numErrors() > 0) {
+		return "error " + to_string(reader.errors().get(0).type());
+	}
+	string values;
+	while (reader.hasValue()) {
+		values += JsonWriter(reader.takeValue()).string().toStdString() + "\n";
+	}
+	return values;
+}
+
+auto check(const string& text, const string& cuts, const string& expected) -> bool {
+	string got = readChunks(text, cuts);
+	if (got != expected) {
+		cerr << "JsonStreamReader read " << text << " cut at " << cuts
+			 << " as:" << endl << got << endl << "instead of:" << endl
+			 << expected << endl;
+		return false;
+	}
+	return true;
+}
+
+}
+
+auto testStreamChunks() -> int {
+	int failures = 0;
+	for (const char* document : documents) {
+		// what JsonReader reads from the whole text at once
+		string text = document;
+		QByteArray bytes(document);
+		QBuffer buffer(&bytes);
+		buffer.open(QIODevice::ReadOnly);
+		string expected = JsonWriter(JsonReader().read(&buffer))
+			.string().toStdString() + "\n";
+
+		// cut in two at every offset
+		for (size_t at = 1; at < text.size(); ++at) {
+			string cuts(text.size(), ' ');
+			cuts[at] = '|';
+			if (!check(text, cuts, expected)) {
+				++failures;
+			}
+		}
+
+		// one byte at a time
+		if (!check(text, string(text.size(), '|'), expected)) {
+			++failures;
+		}
+	}
+	return failures;
+}
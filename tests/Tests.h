@@ -0,0 +1,53 @@
+#ifndef JSON_TESTS_H
+#define JSON_TESTS_H
+
+// Each of these checks one part of the library against another that
+// should give the same answer, prints what differs to stderr, and
+// returns how many checks failed.
+
+// the scanner kernels agree with naive scans on every instruction set
+auto testScanners() -> int;
+
+// both reader engines read the same values and report the same errors
+auto testEngines() -> int;
+
+// numbers are written as text that reads back as exactly the same number
+auto testNumbers() -> int;
+
+// the stream reader reads the same however its text is cut into chunks
+auto testStreamChunks() -> int;
+
+// a batch of large documents is parsed on a small pool
+auto testBatches() -> int;
+
+// a session reads each document the same as a reader does, however
+// the ones before it went
+auto testSessions() -> int;
+
+// a large array is read the same split up over the pool as it is
+// on one thread, wherever the segments happen to start
+auto testParallel() -> int;
+
+// deeply nested documents are limited, or read and written
+// without running out of stack
+auto testDepth() -> int;
+
+// a file written on the pool is replaced whole or not at all
+auto testAsyncWrites() -> int;
+
+// the token reader reads a device a piece at a time, the same
+// way it reads all of the text at once
+auto testTokenStreaming() -> int;
+
+// numbers are read as the nearest double, or exactly as integers
+auto testNumberReading() -> int;
+
+// a log reads the same line by line, however it is cut into chunks,
+// in order or not, and compressed or not
+auto testLinesReader() -> int;
+
+// compressed text comes back the same, and a broken stream is
+// reported as one
+auto testCompression() -> int;
+
+#endif // JSON_TESTS_H
@@ -0,0 +1,103 @@
+#include "Tests.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include <QBuffer>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+// a document of a few megabytes, with strings longer than what
+// is read from a device at a time; it is ASCII, so that its
+// offsets are the same in bytes and in characters
+auto largeDocument(mt19937& random) -> string {
+	string text = "{\"rows\": [";
+	for (int i = 0; i < 20000; ++i) {
+		text += i ? ",\n" : "";
+		text += "{\"id\": " + to_string(i) + ", \"name\": \"r\\u00e9sum\\u00e9 [" + to_string(i)
+			+ "]\", \"score\": " + to_string(random() % 1000) + ".25e-1, \"tags\": [true, null, \"\\u00e9\"]}";
+		if (i % 5000 == 4999) {
+			text += ", \"" + string(100000 + random() % 100000, 'x') + "\"";
+		}
+	}
+	return text + "], \"end\": /* done */ true}";
+}
+
+// every token, with its offset and text, and where it stopped;
+// every fifth array or object is skipped
+auto tokens(JsonTokenReader& reader) -> string {
+	string found;
+	for (int i = 0; ; ++i) {
+		JsonTokenReader::TokenType type = reader.next();
+		if ((type == JsonTokenReader::StartArray || type == JsonTokenReader::StartObject)
+				&& i % 5 == 0) {
+			reader.skipValue();
+			type = reader.tokenType();
+		}
+		found += to_string(type) + "@" + to_string(reader.offset()) + " "
+			+ reader.toString().toStdString() + "\n";
+		if (type == JsonTokenReader::EndOfDocument || type == JsonTokenReader::Invalid) {
+			break;
+		}
+	}
+	for (const JsonReaderError& error : reader.errors()) {
+		found += "error " + to_string(error.type()) + "@" + to_string(error.offset()) + "\n";
+	}
+	return found;
+}
+
+auto check(const string& text, const char* what) -> bool {
+	QByteArray bytes(text.data(), int(text.size()));
+	JsonTokenReader whole{QString::fromUtf8(bytes)};
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	JsonTokenReader streamed(&buffer);
+	if (tokens(streamed) != tokens(whole)) {
+		cerr << "JsonTokenReader read " << what
+			 << " from a device differently than from its text" << endl;
+		return false;
+	}
+	return true;
+}
+
+}
+
+auto testTokenStreaming() -> int {
+	mt19937 random(2014);
+	int failures = 0;
+	string text = largeDocument(random);
+
+	// only the start of the device is read to get to the first value
+	QByteArray bytes(text.data(), int(text.size()));
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	JsonTokenReader reader(&buffer);
+	reader.next();
+	reader.next();
+	reader.next();
+	if (buffer.pos() >= bytes.size() / 2) {
+		cerr << "JsonTokenReader read " << buffer.pos()
+			 << " bytes to get to the first value" << endl;
+		++failures;
+	}
+
+	// the same tokens and errors as from all of the text at once,
+	// with mistakes all through it
+	if (!check(text, "a large document")) {
+		++failures;
+	}
+	for (int i = 0; i < 20; ++i) {
+		string damaged = text;
+		damaged.insert(random() % damaged.size(), i % 2 ? "]" : "\"");
+		if (!check(damaged, "a damaged document")) {
+			++failures;
+		}
+	}
+	return failures;
+}
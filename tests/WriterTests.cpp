@@ -0,0 +1,82 @@
+#include "Tests.h"
+
+#include <iostream>
+#include <string>
+
+#include "../library/include/Json.h"
+
+#include <QFile>
+#include <QFuture>
+#include <QThread>
+
+using namespace std;
+using namespace JSON;
+
+namespace {
+
+const char* path = "async-write.json";
+
+auto contents(const QString& path) -> QByteArray {
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+auto replace(const QString& path, const QByteArray& bytes) -> void {
+	QFile file(path);
+	file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	file.write(bytes);
+}
+
+}
+
+auto testAsyncWrites() -> int {
+	int failures = 0;
+	QByteArray old = "\"old\"";
+
+	// a write that finishes replaces the file
+	JsonArray small;
+	small << JsonValue(1) << JsonValue(2) << JsonValue(3);
+	JsonWriter writer(small);
+	writer.setFormat(JsonWriter::CompactFormat);
+	replace(path, old);
+	QFuture<void> future = writer.writeToAsync(QString(path));
+	future.waitForFinished();
+	if (future.isCanceled() || contents(path) != "[1,2,3]") {
+		cerr << "writeToAsync() did not write " << path << endl;
+		++failures;
+	}
+
+	// one canceled partway leaves the file as it was; it may
+	// also have finished before it could be canceled
+	JsonArray large;
+	for (int i = 0; i < 1000000; ++i) {
+		large << JsonValue(i);
+	}
+	writer.setData(large);
+	replace(path, old);
+	future = writer.writeToAsync(QString(path));
+	while (future.progressValue() == 0 && !future.isFinished()) {
+		QThread::yieldCurrentThread();
+	}
+	future.cancel();
+	future.waitForFinished();
+	QByteArray written = contents(path);
+	if (future.isCanceled() ? written != old : written.size() < 1000000) {
+		cerr << "canceling writeToAsync() left " << written.size()
+			 << " bytes in " << path << endl;
+		++failures;
+	}
+	QFile::remove(path);
+
+	// one that can't open the file says so
+	future = writer.writeToAsync(QString("no such directory/") + path);
+	future.waitForFinished();
+	if (!future.isCanceled()) {
+		cerr << "writeToAsync() to a missing directory was not canceled" << endl;
+		++failures;
+	}
+	return failures;
+}
@@ -3,6 +3,8 @@
 
 #include "../library/include/Json.h"
 
+#include "Tests.h"
+
 #include <QFile>
 
 using namespace std;
@@ -10,6 +12,18 @@ using namespace JSON;
 
 int main()
 {
+	// check the parts that have to agree with each other
+	int failures = testScanners() + testEngines() + testNumbers()
+		+ testStreamChunks() + testBatches() + testSessions()
+		+ testParallel() + testDepth() + testAsyncWrites()
+		+ testTokenStreaming() + testNumberReading() + testLinesReader()
+		+ testCompression();
+	if (failures > 0)
+	{
+		cerr << failures << " checks failed" << endl;
+		return 2;
+	}
+
 	// read it in
 	JsonReaderErrors ok;
 	JsonReader reader;
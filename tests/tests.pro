@@ -6,8 +6,21 @@ TEMPLATE = app
 TARGET = tests
 INCLUDEPATH += .
 
+# the checks of internal classes include their headers
+INCLUDEPATH += ../library/src
+
 # Input
-SOURCES += main.cpp
+HEADERS += Tests.h
+SOURCES += main.cpp \
+           CompressionTests.cpp \
+           EngineTests.cpp \
+           LinesReaderTests.cpp \
+           NumberTests.cpp \
+           ReaderTests.cpp \
+           ScannerTests.cpp \
+           StreamReaderTests.cpp \
+           TokenReaderTests.cpp \
+           WriterTests.cpp
 
 # Additional config
 macx:INCLUDEPATH += /usr/include/